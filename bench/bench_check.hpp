@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace noir::bench {
+	// ends a benchmark with status 1 when one of its correctness checks fails
+	inline void check(const bool condition, const std::string& what) {
+		if (!condition) {
+			std::cerr << "check failed: " << what << std::endl;
+			std::exit(1);
+		}
+	}
+} // namespace noir::bench
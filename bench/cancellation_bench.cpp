@@ -0,0 +1,123 @@
+#include "bench_check.hpp"
+#include "concurrent_transposition_table.hpp"
+#include "ctt_node_manager.hpp"
+#include "sudoku.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stop_token>
+#include <thread>
+
+// How long a stop request takes to return control for growing node limits. A tree filled up to node_limit is
+// re-rooted into its best move once without a stop and once with a stop already requested, the interrupted
+// cleanup is then finished by get_result and both trees are checked to be identical. A live search that keeps
+// pruning is also stopped from another thread at several points and the worst delay until get_task returns is kept.
+// A third tree is re-rooted with thread_count set to every hardware thread and checked against the serial one, and a
+// fourth one with ConcurrentTranspositionTable as dedup policy and at least two threads, so the table is also erased
+// in parallel. Results are printed as
+// "<node_limit> <reroot_us> <stopped_reroot_us> <resume_us> <search_stop_us> <parallel_reroot_us> <concurrent_reroot_us>";
+// a failed check exits with status 1.
+
+namespace {
+	constexpr int kSearchStops = 16;
+
+	using SudokuNodeManager = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc>;
+	using ConcurrentSudokuNodeManager = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc, noir::ctt::NoCanonicalize, noir::ConcurrentTranspositionTable>;
+
+	using noir::bench::check;
+
+	double get_microseconds(const std::chrono::steady_clock::duration duration) {
+		return std::chrono::duration<double, std::micro>(duration).count();
+	}
+
+	template <typename Manager>
+	void expand(Manager& node_sudoku) {
+		constexpr auto all_moves = get_all_possible_moves();
+		for (const auto& child_move : all_moves) {
+			node_sudoku.try_child(child_move, apply_move, [](SudokuState& state) { return state.evaluate(); });
+		}
+		node_sudoku.increment_depth_counter();
+	}
+
+	template <typename Manager>
+	void fill(Manager& node_sudoku, const size_t node_limit, const size_t thread_count = 1) {
+		node_sudoku.get_config().depth = 7;
+		node_sudoku.get_config().thread_count = thread_count;
+		node_sudoku.get_config().node_limit = node_limit;
+		node_sudoku.get_config().prune_depth_limit = 0;
+		node_sudoku.prepare_tree(SudokuState{});
+		while (node_sudoku.get_task() != nullptr) {
+			expand(node_sudoku);
+		}
+	}
+
+	template <typename Func>
+	double measure(Func&& func) {
+		auto now = std::chrono::steady_clock::now();
+		func();
+		return get_microseconds(std::chrono::steady_clock::now() - now);
+	}
+
+	double measure_search_stop(const size_t node_limit) {
+		double worst = 0.0;
+		for (int i = 0; i < kSearchStops; ++i) {
+			SudokuNodeManager node_sudoku;
+			node_sudoku.get_config().node_limit = node_limit;
+			node_sudoku.get_config().prune_depth_limit = 7;
+			node_sudoku.prepare_tree(SudokuState{});
+			std::stop_source stop_source;
+			node_sudoku.set_stop_token(stop_source.get_token());
+			std::chrono::steady_clock::time_point requested;
+			std::thread stopper([&]() {
+				std::this_thread::sleep_for(std::chrono::milliseconds(5 + 7 * i));
+				requested = std::chrono::steady_clock::now();
+				stop_source.request_stop();
+			});
+			while (node_sudoku.get_task() != nullptr) {
+				expand(node_sudoku);
+			}
+			auto returned = std::chrono::steady_clock::now();
+			stopper.join();
+			worst = std::max(worst, get_microseconds(returned - requested));
+		}
+		return worst;
+	}
+} // namespace
+
+int main() {
+	const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+	for (size_t node_limit = 1 << 14; node_limit <= 1 << 20; node_limit <<= 2) {
+		SudokuNodeManager full;
+		SudokuNodeManager stopped;
+		SudokuNodeManager parallel;
+		ConcurrentSudokuNodeManager concurrent;
+		fill(full, node_limit);
+		fill(stopped, node_limit);
+		fill(parallel, node_limit, hardware_threads);
+		fill(concurrent, node_limit, std::max<size_t>(2, hardware_threads));
+		const SudokuState* best = full.get_result();
+		check(best != nullptr, "the filled tree has a result");
+		SudokuState next = *best;
+
+		double reroot = measure([&]() { full.prepare_tree(next); });
+		std::stop_source stop_source;
+		stop_source.request_stop();
+		stopped.set_stop_token(stop_source.get_token());
+		double stopped_reroot = measure([&]() { stopped.prepare_tree(next); });
+		check(stopped.get_task() == nullptr, "no task while stopped");
+		double resume = measure([&]() { stopped.get_result(); });
+		check(!stopped.is_cleanup_pending(), "queries finish the cleanup");
+		check(stopped.get_total_node_count() == full.get_total_node_count(), "an interrupted re-root keeps the same nodes");
+		check(stopped.get_result_value() == full.get_result_value(), "an interrupted re-root keeps the same result");
+		double parallel_reroot = measure([&]() { parallel.prepare_tree(next); });
+		check(parallel.get_total_node_count() == full.get_total_node_count(), "a parallel re-root keeps the same nodes");
+		check(parallel.get_result_value() == full.get_result_value(), "a parallel re-root keeps the same result");
+		double concurrent_reroot = measure([&]() { concurrent.prepare_tree(next); });
+		check(concurrent.get_total_node_count() == full.get_total_node_count(), "a re-root with the concurrent table keeps the same nodes");
+		check(concurrent.get_result_value() == full.get_result_value(), "a re-root with the concurrent table keeps the same result");
+		check(*concurrent.get_result() == *full.get_result(), "a re-root with the concurrent table keeps the same move");
+
+		std::cout << node_limit << " " << reroot << " " << stopped_reroot << " " << resume << " " << measure_search_stop(node_limit) << " "
+		          << parallel_reroot << " " << concurrent_reroot << std::endl;
+	}
+}
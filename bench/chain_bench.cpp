@@ -0,0 +1,154 @@
+#include "bench_check.hpp"
+#include "ctt_node_manager.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Forced moves and compress_chains: a synthetic game where only every kRunLength-th ply offers two moves and every
+// other ply has a single legal one is played to its end at kGoalPly, with a fixed task budget per move, once without
+// and once with compress_chains. A compressed forced move does not use up depth, so the search reaches the end of
+// the game, and stop_on_solution settles the line, several moves earlier. Every played move and solution path is
+// checked to follow the game's rules. Right after a mid-game move and the move that finds the solution, the tree, which
+// then holds chains and terminals, is saved and loaded into a fresh manager that must report the same node count and
+// result, and that searches the next move alongside to the same tree.
+// Results are printed as "<mode> <moves until the solution was found> <tasks/s>"; a failed check exits with status 1.
+
+namespace {
+	constexpr uint64_t kRunLength = 4;
+	constexpr uint64_t kGoalPly = 48;
+	constexpr size_t kDepth = 4;
+	constexpr size_t kTasksPerMove = 2000;
+	constexpr size_t kRoundTripMove = 3;
+
+	// the moves played so far as bits of line, one bit per choice and a zero per forced move
+	struct LineState {
+		uint64_t line = 1;
+		uint64_t ply = 0;
+	};
+
+	struct LineStateEqual {
+		bool operator()(const LineState& left, const LineState& right) const {
+			return left.line == right.line && left.ply == right.ply;
+		}
+	};
+
+	struct LineStateHash {
+		uint64_t operator()(const LineState& state) const {
+			return state.line * 0x9e3779b97f4a7c15 ^ state.ply;
+		}
+	};
+
+	using LineNodeManager = noir::ctt::NodeManager<LineState, LineStateEqual, LineStateHash>;
+	using noir::bench::check;
+
+	int get_move_count(const LineState& state) {
+		return state.ply % kRunLength == kRunLength - 1 ? 2 : 1;
+	}
+
+	void apply_line_move(LineState& state, const int move) {
+		state.line = state.line * 2 + move;
+		++state.ply;
+	}
+
+	noir::ctt::Evaluation evaluate(LineState& state) {
+		uint64_t mixed = state.line * 0xff51afd7ed558ccd;
+		mixed ^= mixed >> 29;
+		return {static_cast<double>(mixed % 1000), state.ply == kGoalPly};
+	}
+
+	bool is_next(const LineState& state, const LineState& next) {
+		return next.ply == state.ply + 1 && next.line >> 1 == state.line && static_cast<int>(next.line & 1) < get_move_count(state);
+	}
+
+	void configure(LineNodeManager& node_line, const bool compress_chains) {
+		node_line.get_config().depth = kDepth;
+		node_line.get_config().node_limit = 100000;
+		node_line.get_config().stop_on_solution = true;
+		node_line.get_config().compress_chains = compress_chains;
+	}
+
+	size_t search(LineNodeManager& node_line) {
+		size_t tasks = 0;
+		for (; tasks < kTasksPerMove; ++tasks) {
+			const LineState* task = node_line.get_task();
+			if (task == nullptr) {
+				break;
+			}
+			for (int child_move = 0; child_move < get_move_count(*task); ++child_move) {
+				node_line.try_child(child_move, apply_line_move, evaluate);
+			}
+			node_line.increment_depth_counter();
+		}
+		return tasks;
+	}
+
+	void check_same_tree(LineNodeManager& node_line, LineNodeManager& loaded, const std::string& what) {
+		check(loaded.get_total_node_count() == node_line.get_total_node_count(), what + " holds the same nodes");
+		const LineState* result = node_line.get_result();
+		const LineState* loaded_result = loaded.get_result();
+		check(result != nullptr && loaded_result != nullptr && LineStateEqual{}(*result, *loaded_result), what + " has the same result");
+		check(loaded.get_result_value() == node_line.get_result_value(), what + " has the same result value");
+	}
+
+	// saves the tree and loads it into a fresh manager that is checked to hold the same tree
+	std::unique_ptr<LineNodeManager> round_trip(LineNodeManager& node_line, const bool compress_chains) {
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "chain_bench.snapshot";
+		node_line.save(path.string());
+		auto loaded = std::make_unique<LineNodeManager>();
+		configure(*loaded, compress_chains);
+		loaded->load(path.string());
+		std::filesystem::remove(path);
+		check(loaded->is_solution_found() == node_line.is_solution_found(), "the loaded tree keeps the solution");
+		check_same_tree(node_line, *loaded, "the loaded tree");
+		return loaded;
+	}
+
+	void play(const bool compress_chains) {
+		LineNodeManager node_line;
+		configure(node_line, compress_chains);
+		LineState line_state;
+		size_t solution_move = 0;
+		size_t tasks = 0;
+		std::chrono::duration<double> elapsed{};
+		std::unique_ptr<LineNodeManager> loaded;
+		for (size_t move = 1; line_state.ply < kGoalPly; ++move) {
+			node_line.prepare_tree(line_state);
+			auto now = std::chrono::steady_clock::now();
+			tasks += search(node_line);
+			elapsed += std::chrono::steady_clock::now() - now;
+			if (loaded != nullptr) {
+				loaded->prepare_tree(line_state);
+				search(*loaded);
+				check_same_tree(node_line, *loaded, "the loaded tree searched on");
+				loaded.reset();
+			}
+			const bool solution_move_now = solution_move == 0 && node_line.is_solution_found();
+			if (solution_move_now) {
+				solution_move = move;
+				LineState previous = line_state;
+				for (const LineState* state : node_line.get_solution_path()) {
+					check(is_next(previous, *state), "the solution path follows the game");
+					previous = *state;
+				}
+				check(previous.ply == kGoalPly, "the solution path ends the game");
+			}
+			if (move == kRoundTripMove || solution_move_now) {
+				loaded = round_trip(node_line, compress_chains);
+			}
+			const LineState* best_state = node_line.get_result();
+			check(best_state != nullptr && is_next(line_state, *best_state), "the result is a legal move");
+			line_state = *best_state;
+		}
+		check(solution_move != 0, "the solution is found before the game ends");
+		std::cout << (compress_chains ? "chains " : "plain ") << solution_move << " " << static_cast<double>(tasks) / elapsed.count() << std::endl;
+	}
+} // namespace
+
+int main() {
+	play(false);
+	play(true);
+}
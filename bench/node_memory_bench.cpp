@@ -0,0 +1,76 @@
+#include "ctt_node_manager.hpp"
+#include "sudoku.hpp"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Allocation churn on one node pool from a growing number of threads: every thread repeatedly
+// allocates a working set of nodes and frees it again, either through its own NodeMemory::Cache
+// or through the plain pool behind a single mutex, which is what sharing it would take otherwise.
+// Results are printed as "<mode>_<threads> <operations/s>".
+
+namespace {
+	constexpr size_t kWorkingSet = 512;
+	constexpr size_t kRounds = 2000;
+
+	using NodeMemory = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc>::Memory;
+	using NodePointer = decltype(std::declval<NodeMemory&>().allocate(nullptr));
+
+	template <typename Worker>
+	double run(const size_t thread_count, Worker worker) {
+		NodeMemory memory;
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count);
+		auto now = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < thread_count; ++i) {
+			threads.emplace_back([&memory, &worker]() { worker(memory); });
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - now;
+		return static_cast<double>(2 * kWorkingSet * kRounds * thread_count) / elapsed.count();
+	}
+
+	template <typename Allocate, typename Deallocate>
+	void churn(Allocate allocate, Deallocate deallocate) {
+		std::vector<NodePointer> nodes(kWorkingSet);
+		for (size_t round = 0; round < kRounds; ++round) {
+			nodes[0] = allocate(nullptr);
+			for (size_t i = 1; i < kWorkingSet; ++i) {
+				nodes[i] = allocate(nodes[i / 2]);
+			}
+			for (size_t i = kWorkingSet; i-- > 0;) {
+				deallocate(nodes[i]);
+			}
+		}
+	}
+} // namespace
+
+int main() {
+	size_t max_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+	for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+		std::mutex pool_mutex;
+		double locked = run(thread_count, [&pool_mutex](NodeMemory& memory) {
+			churn(
+			    [&](NodePointer parent) {
+				    std::lock_guard lock(pool_mutex);
+				    return memory.allocate(parent);
+			    },
+			    [&](NodePointer node) {
+				    std::lock_guard lock(pool_mutex);
+				    memory.deallocate(node);
+			    });
+		});
+		double cached = run(thread_count, [](NodeMemory& memory) {
+			NodeMemory::Cache cache(memory);
+			churn([&](NodePointer parent) { return cache.allocate(parent); }, [&](NodePointer node) { cache.deallocate(node); });
+		});
+		std::cout << "locked_" << thread_count << " " << locked << std::endl;
+		std::cout << "cached_" << thread_count << " " << cached << std::endl;
+	}
+}
@@ -0,0 +1,23 @@
+#!/bin/sh
+# Builds the release preset, trains an instrumented build on the sudoku corpus,
+# rebuilds with the profile and LTO, then reports the speedup of the PGO build over release.
+# Both PGO stages share build/pgo so the profile matches the object paths of the final build.
+set -e
+cd "$(dirname "$0")/.."
+
+cmake --preset release
+cmake --build --preset release
+./build/release/sudoku_bench > build/release/bench_output.txt
+
+rm -rf build/pgo-profile
+cmake --preset pgo-generate
+cmake --build --preset pgo-generate
+./build/pgo/sudoku_bench > /dev/null
+# clang writes raw profiles that must be merged, gcc reads its .gcda files directly
+if ls build/pgo-profile/*.profraw > /dev/null 2>&1; then
+	llvm-profdata merge -output=build/pgo-profile/default.profdata build/pgo-profile/*.profraw
+fi
+
+cmake --preset pgo-use
+cmake --build --preset pgo-use
+./build/pgo/sudoku_bench build/release/bench_output.txt
@@ -0,0 +1,126 @@
+#include "bench_check.hpp"
+#include "ctt_node_manager.hpp"
+#include "shared_transposition_table.hpp"
+#include "sudoku.hpp"
+#include "sudoku_corpus.hpp"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Checks that SharedTranspositionTable rejects a segment of another layout, then shares one table between two
+// processes: the parent searches a corpus puzzle with the table attached, and a forked child attaches to the same
+// segment by name and searches the same position, where it must hit the parent's evaluations and reach the same
+// result. Results are printed as "<process> <tasks/s>" for the parent filling the table and the child reusing it;
+// a failed check exits with status 1.
+
+namespace {
+	constexpr size_t kCapacity = 1 << 20;
+	constexpr size_t kTasks = 256; // a Sudoku expansion tries all 729 moves
+
+	using SudokuNodeManager = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc>;
+
+	using noir::bench::check;
+
+	bool is_rejected(const std::string& name) {
+		try {
+			noir::SharedTranspositionTable table(name, kCapacity);
+		} catch (const std::runtime_error& error) {
+			return std::string(error.what()).starts_with("incompatible shared memory");
+		}
+		return false;
+	}
+
+	// writes over the first word of the segment, the table's magic
+	void overwrite_magic(const std::string& name, const uint64_t magic) {
+		int fd = shm_open(name.c_str(), O_RDWR, 0600);
+		check(fd >= 0, "the segment opens");
+		void* data = mmap(nullptr, sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		check(data != MAP_FAILED, "the segment maps");
+		uint64_t* word = static_cast<uint64_t*>(data);
+		*word = magic ^ *word;
+		munmap(data, sizeof(uint64_t));
+	}
+
+	void check_layout(const std::string& name) {
+		noir::SharedTranspositionTable::unlink(name);
+		{
+			noir::SharedTranspositionTable table(name, kCapacity);
+		}
+		overwrite_magic(name, 1);
+		check(is_rejected(name), "a segment with another magic is rejected");
+		overwrite_magic(name, 1);
+		check(!is_rejected(name), "the restored magic attaches again");
+
+		// a segment resized after creation no longer matches the capacity in its header
+		int fd = shm_open(name.c_str(), O_RDWR, 0600);
+		struct stat segment_stat;
+		check(fd >= 0 && fstat(fd, &segment_stat) == 0 && ftruncate(fd, 2 * segment_stat.st_size) == 0, "the segment grows");
+		close(fd);
+		check(is_rejected(name), "a segment of another size is rejected");
+		noir::SharedTranspositionTable::unlink(name);
+		std::cout << "layout ok" << std::endl;
+	}
+
+	size_t search(SudokuNodeManager& node_sudoku, std::chrono::duration<double>& elapsed) {
+		constexpr auto all_moves = get_all_possible_moves();
+		auto now = std::chrono::steady_clock::now();
+		size_t tasks = 0;
+		for (; tasks < kTasks && node_sudoku.get_task() != nullptr; ++tasks) {
+			for (const auto& child_move : all_moves) {
+				node_sudoku.try_child(child_move, apply_move, [](SudokuState& state) { return state.evaluate(); });
+			}
+			node_sudoku.increment_depth_counter();
+		}
+		elapsed = std::chrono::steady_clock::now() - now;
+		return tasks;
+	}
+
+	void share(const std::string& name, const SudokuState& start) {
+		noir::SharedTranspositionTable::unlink(name);
+		noir::SharedTranspositionTable table(name, kCapacity);
+		SudokuNodeManager node_sudoku;
+		node_sudoku.set_shared_table(&table);
+		node_sudoku.prepare_tree(start);
+		std::chrono::duration<double> elapsed{};
+		size_t tasks = search(node_sudoku, elapsed);
+		check(tasks != 0, "the parent searches");
+		const SudokuState* result = node_sudoku.get_result();
+		check(result != nullptr, "the parent finds a result");
+		std::cout << "parent " << static_cast<double>(tasks) / elapsed.count() << std::endl;
+
+		pid_t child = fork();
+		check(child >= 0, "the child forks");
+		if (child == 0) {
+			// attaches by name like an unrelated process would, the parent's mapping is not used
+			noir::SharedTranspositionTable attached(name, kCapacity);
+			SudokuNodeManager child_sudoku;
+			child_sudoku.set_shared_table(&attached);
+			child_sudoku.prepare_tree(start);
+			size_t child_tasks = search(child_sudoku, elapsed);
+			check(child_sudoku.get_total_shared_hit_count() != 0, "the child hits the parent's evaluations");
+			const SudokuState* child_result = child_sudoku.get_result();
+			check(child_result != nullptr && CollisionFunc<SudokuState>{}(*child_result, *result), "the child reaches the parent's result");
+			std::cout << "child " << static_cast<double>(child_tasks) / elapsed.count() << std::endl;
+			_exit(0);
+		}
+		int status = 0;
+		check(waitpid(child, &status, 0) == child, "the child is waited for");
+		noir::SharedTranspositionTable::unlink(name);
+		check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "the child passes its checks");
+	}
+} // namespace
+
+int main() {
+	const std::string name = "/noir_shared_table_bench." + std::to_string(getpid());
+	check_layout(name);
+	share(name, parse_sudoku(kSudokuCorpus[1].cells));
+}
@@ -0,0 +1,128 @@
+#include "bench_check.hpp"
+#include "ctt_node_manager.hpp"
+#include "seqlock.hpp"
+#include "sudoku.hpp"
+#include "sudoku_corpus.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Checks that SeqLock readers never see a torn value while one writer stores, then measures what publishing
+// search snapshots costs: a corpus puzzle is played with a fixed number of expansions for several
+// snapshot_interval values while a monitor thread keeps reading the snapshot. A move ends when get_task runs out of
+// tasks at node_limit, the puzzle starts over once solved, and only the searches between re-roots are timed.
+// Results are printed as "interval_<n> <expansions/s>"; a failed check exits with status 1.
+
+namespace {
+	constexpr size_t kStressStores = 1 << 20;
+	constexpr size_t kExpansions = 4096; // a Sudoku expansion tries all 729 moves
+
+	using SudokuNodeManager = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc>;
+
+	using noir::bench::check;
+
+	void stress() {
+		using Value = std::array<uint64_t, 16>;
+		noir::SeqLock<Value> seqlock;
+		std::atomic<bool> done = false;
+		size_t reader_count = std::max<size_t>(2, std::thread::hardware_concurrency()) - 1;
+		std::vector<size_t> torn(reader_count);
+		std::vector<size_t> regressed(reader_count);
+		std::vector<std::thread> readers;
+		for (size_t i = 0; i < reader_count; ++i) {
+			readers.emplace_back([&, i]() {
+				uint64_t last = 0;
+				while (!done.load(std::memory_order_acquire)) {
+					Value value = seqlock.load();
+					torn[i] += std::any_of(value.begin(), value.end(), [&](const uint64_t word) { return word != value[0]; });
+					regressed[i] += value[0] < last;
+					last = value[0];
+				}
+			});
+		}
+		for (uint64_t i = 1; i <= kStressStores; ++i) {
+			Value value;
+			value.fill(i);
+			seqlock.store(value);
+		}
+		done.store(true, std::memory_order_release);
+		for (std::thread& reader : readers) {
+			reader.join();
+		}
+		for (size_t i = 0; i < reader_count; ++i) {
+			check(torn[i] == 0, "readers never see a partly stored value");
+			check(regressed[i] == 0, "readers never go back to an older value");
+		}
+		check(seqlock.get_version() == kStressStores, "one version per store");
+		check(seqlock.load()[0] == kStressStores, "the last store is read back");
+		std::cout << "stress ok" << std::endl;
+	}
+
+	// searches the tree of node_sudoku for up to budget tasks while a monitor thread reads the snapshot,
+	// returns the tasks taken
+	size_t search_move(SudokuNodeManager& node_sudoku, const size_t budget, std::chrono::duration<double>& elapsed) {
+		std::atomic<bool> done = false;
+		const uint64_t first_version = node_sudoku.get_snapshot_version();
+		std::thread monitor([&]() {
+			uint64_t last_searched = 0;
+			while (!done.load(std::memory_order_acquire)) {
+				// the snapshot of the move before still counts the searches of the old tree
+				if (node_sudoku.get_snapshot_version() == first_version) {
+					continue;
+				}
+				SudokuNodeManager::SearchSnapshot snapshot = node_sudoku.read_snapshot();
+				check(snapshot.searched >= last_searched, "published counters only grow during a search");
+				last_searched = snapshot.searched;
+			}
+		});
+		constexpr auto all_moves = get_all_possible_moves();
+		auto now = std::chrono::steady_clock::now();
+		size_t expansions = 0;
+		for (; expansions < budget && node_sudoku.get_task() != nullptr; ++expansions) {
+			for (const auto& child_move : all_moves) {
+				node_sudoku.try_child(child_move, apply_move, [](SudokuState& state) { return state.evaluate(); });
+			}
+			node_sudoku.increment_depth_counter();
+		}
+		elapsed += std::chrono::steady_clock::now() - now;
+		done.store(true, std::memory_order_release);
+		monitor.join();
+		return expansions;
+	}
+
+	double measure(const SudokuState& start, const size_t interval) {
+		SudokuNodeManager node_sudoku;
+		node_sudoku.get_config().snapshot_interval = interval;
+		SudokuState sudoku_state = start;
+		std::chrono::duration<double> elapsed{};
+		size_t expansions = 0;
+		while (expansions < kExpansions) {
+			node_sudoku.prepare_tree(sudoku_state);
+			const uint64_t version = node_sudoku.get_snapshot_version();
+			size_t taken = search_move(node_sudoku, kExpansions - expansions, elapsed);
+			check(taken != 0, "every move searches");
+			check(node_sudoku.get_snapshot_version() - version >= (interval == 0 ? 0 : taken / interval), "every interval tasks publish");
+			expansions += taken;
+			const SudokuState* best_state = node_sudoku.get_result();
+			check(best_state != nullptr, "every move finds a result");
+			apply_move(sudoku_state, best_state->decision);
+			if (sudoku_state.is_solved()) {
+				sudoku_state = start;
+			}
+		}
+		check(interval != 0 || node_sudoku.get_snapshot_version() == 0, "no snapshot is published without an interval");
+		return static_cast<double>(expansions) / elapsed.count();
+	}
+} // namespace
+
+int main() {
+	stress();
+	SudokuState start = parse_sudoku(kSudokuCorpus[1].cells);
+	for (size_t interval : {0, 1, 16, 256}) {
+		std::cout << "interval_" << interval << " " << measure(start, interval) << std::endl;
+	}
+}
@@ -0,0 +1,242 @@
+#include "concurrent_transposition_table.hpp"
+#include "ctt_ensemble.hpp"
+#include "ctt_node_manager.hpp"
+#include "sudoku.hpp"
+#include "sudoku_corpus.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+// Plays every corpus puzzle with a fixed expansion budget per move instead of a time budget,
+// so the amount of work is identical between builds and only the elapsed time differs.
+// usage: sudoku_bench [baseline_file]
+// Results are printed as "<name> <expansions/s>"; when a baseline file produced by a previous run
+// is given, the speedup against it is reported as a third column.
+// "<name>_batch" rows repeat the puzzle through expand_batch on every hardware thread, whose tree does not
+// depend on the thread count, so they stay comparable between machines. "<name>_pipeline" rows go through
+// expand_pipeline with the evaluators filling the hardware threads left by the generator and the caller.
+// "<name>_batch_numa" rows are the batch rows with numa_aware workers, followed by a "remote_ratio_batch_numa"
+// row with the share of sampled task node reads that went to another NUMA node. "<name>_ensemble" rows search
+// one Ensemble instance per hardware thread, at least two, with depths 6 to 8 and the same expansion budget per
+// instance, counting the expansions of all instances. "<name>_batch_concurrent" rows are the batch rows with
+// ConcurrentTranspositionTable as the manager's dedup policy. "<name>_beam" rows play in beam mode through
+// expand_beam_layer on every hardware thread, counting expanded parents, and "<name>_beam_bound" rows do the
+// same with Sudoku's decision bound, so children that cannot enter the beam skip evaluate(). A
+// "bound_skip_ratio_beam_bound" row follows with the share of children the bound skipped.
+
+namespace {
+	constexpr size_t kExpansionsPerMove = 200;
+	constexpr size_t kMaxMoves = 10;
+	constexpr int kRepetitions = 3;
+
+	using SudokuNodeManager = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc>;
+	using ConcurrentSudokuNodeManager = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc, noir::ctt::NoCanonicalize, noir::ConcurrentTranspositionTable>;
+	using SudokuEnsemble = noir::ctt::Ensemble<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc>;
+
+	enum class Driver {
+		serial,
+		batch,
+		batch_numa,
+		batch_concurrent,
+		pipeline,
+		ensemble,
+		beam,
+		beam_bound,
+	};
+
+	// children evaluated and children skipped by a bound, summed over the moves of a game
+	struct ChildCounts {
+		size_t searched = 0;
+		size_t bound_skipped = 0;
+	};
+
+	template <typename Manager>
+	void configure(Manager& node_sudoku) {
+		node_sudoku.get_config().depth = 7;
+		node_sudoku.get_config().node_limit = 100000;
+		node_sudoku.get_config().prune_depth_limit = 0;
+	}
+
+	template <typename Manager>
+	size_t play(Manager& node_sudoku, SudokuState sudoku_state, const Driver driver, ChildCounts& child_counts) {
+		constexpr auto all_moves = get_all_possible_moves();
+		auto evaluate = [](SudokuState& state) { return state.evaluate(); };
+		size_t expansions = 0;
+		std::atomic<size_t> beam_parents = 0;
+		for (size_t move = 0; move < kMaxMoves && !sudoku_state.is_solved(); ++move) {
+			node_sudoku.prepare_tree(sudoku_state);
+			for (size_t i = 0; i < kExpansionsPerMove;) {
+				size_t taken = 1;
+				if (driver == Driver::batch || driver == Driver::batch_numa || driver == Driver::batch_concurrent) {
+					taken = node_sudoku.expand_batch([&](const SudokuState&, typename Manager::ChildSink& sink) {
+						for (const auto& child_move : all_moves) {
+							sink.try_child(child_move, apply_move, evaluate);
+						}
+					});
+				} else if (driver == Driver::pipeline) {
+					auto generate = [&](const SudokuState&, typename Manager::GenerateSink& sink) {
+						for (const auto& child_move : all_moves) {
+							sink.try_child(child_move, apply_move);
+						}
+					};
+					taken = node_sudoku.expand_pipeline(kExpansionsPerMove - i, generate, evaluate);
+				} else if (driver == Driver::beam || driver == Driver::beam_bound) {
+					size_t parents_before = beam_parents.load(std::memory_order_relaxed);
+					bool committed = node_sudoku.expand_beam_layer([&](const SudokuState& parent, typename Manager::ChildSink& sink) {
+						beam_parents.fetch_add(1, std::memory_order_relaxed);
+						if (driver == Driver::beam) {
+							for (const auto& child_move : all_moves) {
+								sink.try_child(child_move, apply_move, evaluate);
+							}
+							return;
+						}
+						double parent_value = SudokuState(parent).evaluate();
+						auto bound = [parent_value](const SudokuState& state) { return state.get_decision_bound(parent_value); };
+						for (const auto& child_move : all_moves) {
+							sink.try_child(child_move, apply_move, bound, evaluate);
+						}
+					}) != 0;
+					taken = committed ? beam_parents.load(std::memory_order_relaxed) - parents_before : 0;
+				} else if (node_sudoku.get_task() != nullptr) {
+					for (const auto& child_move : all_moves) {
+						node_sudoku.try_child(child_move, apply_move, evaluate);
+					}
+					node_sudoku.increment_depth_counter();
+				} else {
+					taken = 0;
+				}
+				if (taken == 0) {
+					break;
+				}
+				i += taken;
+				expansions += taken;
+			}
+			child_counts.searched += node_sudoku.get_total_searched_count();
+			child_counts.bound_skipped += node_sudoku.get_total_bound_skip_count();
+			auto best_state = node_sudoku.get_result();
+			if (best_state == nullptr) {
+				break;
+			}
+			apply_move(sudoku_state, best_state->decision);
+		}
+		return expansions;
+	}
+
+	size_t play_ensemble(SudokuEnsemble& ensemble, SudokuState sudoku_state) {
+		constexpr auto all_moves = get_all_possible_moves();
+		auto evaluate = [](SudokuState& state) { return state.evaluate(); };
+		size_t expansions = 0;
+		for (size_t move = 0; move < kMaxMoves && !sudoku_state.is_solved(); ++move) {
+			ensemble.prepare_tree(sudoku_state);
+			expansions += ensemble.search(kExpansionsPerMove, [&](SudokuEnsemble::Manager& node_sudoku, SudokuState&, size_t) {
+				for (const auto& child_move : all_moves) {
+					node_sudoku.try_child(child_move, apply_move, evaluate);
+				}
+			});
+			auto best_state = ensemble.get_result();
+			if (best_state == nullptr) {
+				break;
+			}
+			apply_move(sudoku_state, best_state->decision);
+		}
+		return expansions;
+	}
+
+	std::map<std::string, double> read_baseline(const char* path) {
+		std::map<std::string, double> baseline;
+		std::ifstream file(path);
+		std::string name;
+		double value;
+		while (file >> name >> value) {
+			baseline[name] = value;
+		}
+		return baseline;
+	}
+} // namespace
+
+int main(int argc, char** argv) {
+	std::map<std::string, double> baseline;
+	if (argc > 1) {
+		baseline = read_baseline(argv[1]);
+	}
+	auto report = [&baseline](const std::string& name, double rate) {
+		std::cout << name << " " << rate;
+		auto it = baseline.find(name);
+		if (it != baseline.end() && it->second > 0.0) {
+			std::cout << " " << rate / it->second << "x";
+		}
+		std::cout << std::endl;
+	};
+	const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+	for (const Driver driver : {Driver::serial, Driver::batch, Driver::batch_numa, Driver::batch_concurrent, Driver::pipeline, Driver::ensemble, Driver::beam, Driver::beam_bound}) {
+		size_t total_expansions = 0;
+		double total_seconds = 0.0;
+		size_t numa_local = 0;
+		size_t numa_remote = 0;
+		ChildCounts child_counts;
+		std::string suffix = driver == Driver::batch              ? "_batch"
+		                     : driver == Driver::batch_numa       ? "_batch_numa"
+		                     : driver == Driver::batch_concurrent ? "_batch_concurrent"
+		                     : driver == Driver::pipeline         ? "_pipeline"
+		                     : driver == Driver::ensemble         ? "_ensemble"
+		                     : driver == Driver::beam             ? "_beam"
+		                     : driver == Driver::beam_bound       ? "_beam_bound"
+		                                                          : "";
+		for (const SudokuPuzzle& puzzle : kSudokuCorpus) {
+			SudokuState start = parse_sudoku(puzzle.cells);
+			double best_seconds = std::numeric_limits<double>::max();
+			size_t expansions = 0;
+			for (int i = 0; i < kRepetitions; ++i) {
+				if (driver == Driver::ensemble) {
+					SudokuEnsemble ensemble(std::max<size_t>(2, hardware_threads));
+					for (size_t instance = 0; instance < ensemble.size(); ++instance) {
+						configure(ensemble.get_instance(instance));
+						ensemble.get_instance(instance).get_config().depth = 6 + instance % 3;
+					}
+					auto now = std::chrono::steady_clock::now();
+					expansions = play_ensemble(ensemble, start);
+					std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - now;
+					best_seconds = std::min(best_seconds, elapsed.count());
+					continue;
+				}
+				auto run = [&](auto& node_sudoku) {
+					configure(node_sudoku);
+					node_sudoku.get_config().thread_count = driver == Driver::pipeline ? std::max<size_t>(3, hardware_threads) - 2 : hardware_threads;
+					node_sudoku.get_config().numa_aware = driver == Driver::batch_numa;
+					if (driver == Driver::beam || driver == Driver::beam_bound) {
+						node_sudoku.get_config().mode = noir::ctt::SearchMode::beam;
+					}
+					auto now = std::chrono::steady_clock::now();
+					expansions = play(node_sudoku, start, driver, child_counts);
+					std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - now;
+					best_seconds = std::min(best_seconds, elapsed.count());
+					numa_local += node_sudoku.get_total_numa_local_count();
+					numa_remote += node_sudoku.get_total_numa_remote_count();
+				};
+				if (driver == Driver::batch_concurrent) {
+					ConcurrentSudokuNodeManager node_sudoku;
+					run(node_sudoku);
+				} else {
+					SudokuNodeManager node_sudoku;
+					run(node_sudoku);
+				}
+			}
+			total_expansions += expansions;
+			total_seconds += best_seconds;
+			report(std::string(puzzle.name) + suffix, static_cast<double>(expansions) / best_seconds);
+		}
+		report("total" + suffix, static_cast<double>(total_expansions) / total_seconds);
+		if (driver == Driver::batch_numa) {
+			size_t sampled = numa_local + numa_remote;
+			report("remote_ratio" + suffix, sampled == 0 ? 0.0 : static_cast<double>(numa_remote) / static_cast<double>(sampled));
+		}
+		if (driver == Driver::beam_bound) {
+			size_t children = child_counts.searched + child_counts.bound_skipped;
+			report("bound_skip_ratio" + suffix, children == 0 ? 0.0 : static_cast<double>(child_counts.bound_skipped) / static_cast<double>(children));
+		}
+	}
+}
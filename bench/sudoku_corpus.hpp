@@ -0,0 +1,17 @@
+#pragma once
+#include <array>
+#include <string_view>
+
+// row-major, 0 = empty
+struct SudokuPuzzle {
+	std::string_view name;
+	std::string_view cells;
+};
+
+constexpr std::array<SudokuPuzzle, 5> kSudokuCorpus = {{
+    {"empty", "000000000000000000000000000000000000000000000000000000000000000000000000000000000"},
+    {"classic", "530070000600195000098000060800060003400803001700020006060000280000419005000080079"},
+    {"euler01", "003020600900305001001806400008102900700000008006708200002609500800203009005010300"},
+    {"euler02", "200080300060070084030500209000105408000000000402706000301007040720040060004010003"},
+    {"euler03", "000000907000420180000705026100904000050000040000507009920108000034059000507000000"},
+}};
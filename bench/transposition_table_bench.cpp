@@ -0,0 +1,137 @@
+#include "bench_check.hpp"
+#include "concurrent_transposition_table.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Checks ConcurrentTranspositionTable under concurrent inserts and erases, then measures insert throughput
+// from 1 to N threads against a mutex-guarded std::unordered_map.
+// Threads insert in pairs over the same keys in different orders, so with two or more threads half of the
+// attempts are duplicates. Results are printed as "<mode>_<threads> <inserts/s>"; a failed check exits with status 1.
+
+namespace {
+	constexpr size_t kStressKeys = 1 << 16;
+	constexpr size_t kBenchKeys = 1 << 20;
+
+	uint64_t mix(uint64_t x) {
+		x += 0x9e3779b97f4a7c15;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+		return x ^ (x >> 31);
+	}
+
+	// the i-th key a thread visits, a different order per thread
+	size_t get_key(const size_t thread_index, const size_t i, const size_t key_count) {
+		return (i * (2 * thread_index + 1) + thread_index * 7919) % key_count;
+	}
+
+	size_t get_thread_count() {
+		return std::max<size_t>(4, std::thread::hardware_concurrency());
+	}
+
+	template <typename Worker>
+	void run_threads(const size_t thread_count, Worker worker) {
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count);
+		for (size_t i = 0; i < thread_count; ++i) {
+			threads.emplace_back(worker, i);
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	using noir::bench::check;
+
+	void stress() {
+		const size_t thread_count = get_thread_count();
+		noir::ConcurrentTranspositionTable table;
+		table.reserve(2 * kStressKeys);
+
+		// racing inserts of one key set: exactly one winner per key
+		std::vector<size_t> inserted(thread_count);
+		run_threads(thread_count, [&](const size_t thread_index) {
+			for (size_t i = 0; i < kStressKeys; ++i) {
+				size_t key = get_key(thread_index, i, kStressKeys);
+				inserted[thread_index] += table.try_emplace(mix(key), static_cast<uint32_t>(key)).second;
+			}
+		});
+		size_t total_inserted = 0;
+		for (size_t count : inserted) {
+			total_inserted += count;
+		}
+		check(total_inserted == kStressKeys, "one insert per key");
+		for (size_t key = 0; key < kStressKeys; ++key) {
+			check(table.find(mix(key)) == key, "inserted key is found with its index");
+		}
+
+		// erasing even keys while odd keys are looked up and new keys are inserted
+		std::vector<size_t> missing(thread_count);
+		run_threads(thread_count, [&](const size_t thread_index) {
+			size_t slots = table.slot_count();
+			size_t share = (slots + thread_count - 1) / thread_count;
+			size_t first = std::min(slots, thread_index * share);
+			table.erase_if([](const uint32_t index) { return index % 2 == 0; }, first, std::min(slots, first + share));
+			for (size_t i = 0; i < kStressKeys; ++i) {
+				size_t key = get_key(thread_index, i, kStressKeys);
+				if (key % 2 == 1 && table.find(mix(key)) != key) {
+					++missing[thread_index];
+				}
+				if (key % thread_count == thread_index) {
+					// odd indices, the concurrent erase must leave them alone
+					size_t new_key = kStressKeys + key;
+					table.try_emplace(mix(new_key), static_cast<uint32_t>(2 * new_key + 1));
+				}
+			}
+		});
+		for (size_t count : missing) {
+			check(count == 0, "odd keys stay visible while even keys are erased");
+		}
+		for (size_t key = 0; key < kStressKeys; ++key) {
+			uint32_t expected = key % 2 == 0 ? noir::ConcurrentTranspositionTable::kNone : static_cast<uint32_t>(key);
+			check(table.find(mix(key)) == expected, "only even keys are erased");
+			check(table.find(mix(kStressKeys + key)) == 2 * (kStressKeys + key) + 1, "keys inserted during the erase are kept");
+		}
+
+		// erased keys can be inserted again after the tombstones are dropped
+		table.reserve(2 * kStressKeys);
+		for (size_t key = 0; key < kStressKeys; key += 2) {
+			check(table.try_emplace(mix(key), static_cast<uint32_t>(key)).second, "erased key inserts again");
+		}
+		std::cout << "stress ok" << std::endl;
+	}
+
+	double measure(const size_t thread_count, auto insert) {
+		auto now = std::chrono::steady_clock::now();
+		run_threads(thread_count, [&](const size_t thread_index) {
+			for (size_t i = 0; i < kBenchKeys; ++i) {
+				size_t key = get_key(thread_index % 2, i, kBenchKeys) + (thread_index / 2) * kBenchKeys;
+				insert(mix(key), static_cast<uint32_t>(key % noir::ConcurrentTranspositionTable::kMaxIndex));
+			}
+		});
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - now;
+		return static_cast<double>(kBenchKeys * thread_count) / elapsed.count();
+	}
+} // namespace
+
+int main() {
+	stress();
+	for (size_t thread_count = 1; thread_count <= get_thread_count(); thread_count *= 2) {
+		std::unordered_map<uint64_t, uint32_t> map;
+		std::mutex map_mutex;
+		map.reserve(kBenchKeys * (thread_count + 1) / 2);
+		double locked = measure(thread_count, [&](const uint64_t hash, const uint32_t index) {
+			std::lock_guard lock(map_mutex);
+			map.try_emplace(hash, index);
+		});
+		noir::ConcurrentTranspositionTable table;
+		table.reserve(kBenchKeys * (thread_count + 1) / 2);
+		double lock_free = measure(thread_count, [&](const uint64_t hash, const uint32_t index) { table.try_emplace(hash, index); });
+		std::cout << "locked_map_" << thread_count << " " << locked << std::endl;
+		std::cout << "lock_free_" << thread_count << " " << lock_free << std::endl;
+	}
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace noir {
+	// Lock-free open-addressing (hash -> node index) set for several threads inserting at once.
+	// An entry is one word, a 40-bit fingerprint above a 24-bit index, claimed with a single CAS on an empty slot;
+	// threads racing for the same hash walk the same probe sequence, so exactly one of them inserts.
+	// Erasing leaves a tombstone and may run concurrently with lookups and inserts. Only reserve() and clear()
+	// need the table to themselves, they also drop the tombstones. Hashes sharing a fingerprint count as equal.
+	// As NodeManager's dedup policy only erasing runs on several threads, in the parallel cleanup: expand_batch and
+	// expand_pipeline commit on the calling thread, so the manager inserts from one thread at a time.
+	class ConcurrentTranspositionTable {
+	    private:
+		static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+		static constexpr int kIndexBits = 24;
+		static constexpr uint64_t kIndexMask = (uint64_t{1} << kIndexBits) - 1;
+		static constexpr uint64_t kFingerprintMask = (uint64_t{1} << (64 - kIndexBits)) - 1;
+		static constexpr uint64_t kEmpty = 0;
+		static constexpr uint64_t kTombstone = std::numeric_limits<uint64_t>::max();
+		static constexpr size_t kMinCapacity = 64;
+
+		std::unique_ptr<std::atomic<uint64_t>[]> entries;
+		size_t capacity = 0;
+		uint64_t mask = 0;
+		std::atomic<size_t> tombstone_count = 0;
+
+		// 0 and all ones are kept free so an entry is never kEmpty or kTombstone
+		static uint64_t get_fingerprint(const uint64_t hash) {
+			uint64_t fingerprint = hash >> kIndexBits;
+			if (fingerprint == 0) {
+				return 1;
+			}
+			if (fingerprint == kFingerprintMask) {
+				return kFingerprintMask - 1;
+			}
+			return fingerprint;
+		}
+
+		static uint64_t pack(const uint64_t fingerprint, const uint32_t index) {
+			return fingerprint << kIndexBits | (index & kIndexMask);
+		}
+
+		static uint32_t unpack_index(const uint64_t entry) {
+			uint32_t index = static_cast<uint32_t>(entry & kIndexMask);
+			return index == kIndexMask ? kNone : index;
+		}
+
+		// the home slot comes from the fingerprint so entries can move to a larger table without their hash
+		void insert_unique(const uint64_t entry) {
+			for (uint64_t slot = (entry >> kIndexBits) & mask;; slot = (slot + 1) & mask) {
+				if (entries[slot].load(std::memory_order_relaxed) == kEmpty) {
+					entries[slot].store(entry, std::memory_order_relaxed);
+					return;
+				}
+			}
+		}
+
+	    public:
+		using Slot = std::atomic<uint64_t>*;
+
+		// index reported for entries inserted without one yet, see assign()
+		static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t kMaxIndex = static_cast<uint32_t>(kIndexMask - 1);
+		static constexpr bool kConcurrentErase = true; // erase_if may run on disjoint slot ranges from several threads
+
+		ConcurrentTranspositionTable() {
+			reserve(kMinCapacity / 2);
+		}
+
+		// {slot of hash, true} when this call inserted it, {slot of hash, false} when it was already present
+		std::pair<Slot, bool> try_emplace(const uint64_t hash, const uint32_t index) {
+			if (index != kNone && index > kMaxIndex) {
+				throw std::runtime_error("node index does not fit the concurrent transposition table");
+			}
+			const uint64_t fingerprint = get_fingerprint(hash);
+			const uint64_t desired = pack(fingerprint, index);
+			uint64_t slot = fingerprint & mask;
+			for (size_t probe = 0; probe < capacity; ++probe, slot = (slot + 1) & mask) {
+				uint64_t entry = entries[slot].load(std::memory_order_acquire);
+				if (entry == kEmpty) {
+					if (entries[slot].compare_exchange_strong(entry, desired, std::memory_order_acq_rel, std::memory_order_acquire)) {
+						return {&entries[slot], true};
+					}
+					// lost the slot, entry now holds the winner
+				}
+				if (entry != kTombstone && entry >> kIndexBits == fingerprint) {
+					return {&entries[slot], false};
+				}
+			}
+			throw std::runtime_error("concurrent transposition table is full");
+		}
+
+		// sets the index of an entry inserted with kNone, unless it was erased in the meantime
+		static void assign(const Slot slot, const uint32_t index) {
+			if (index > kMaxIndex) {
+				throw std::runtime_error("node index does not fit the concurrent transposition table");
+			}
+			uint64_t entry = slot->load(std::memory_order_relaxed);
+			if (entry != kTombstone) {
+				slot->compare_exchange_strong(entry, pack(entry >> kIndexBits, index), std::memory_order_release, std::memory_order_relaxed);
+			}
+		}
+
+		void assign(const uint64_t hash, const uint32_t index) {
+			auto [slot, inserted] = try_emplace(hash, index);
+			if (!inserted) {
+				assign(slot, index);
+			}
+		}
+
+		uint32_t find(const uint64_t hash) const {
+			const uint64_t fingerprint = get_fingerprint(hash);
+			uint64_t slot = fingerprint & mask;
+			for (size_t probe = 0; probe < capacity; ++probe, slot = (slot + 1) & mask) {
+				uint64_t entry = entries[slot].load(std::memory_order_acquire);
+				if (entry == kEmpty) {
+					break;
+				}
+				if (entry != kTombstone && entry >> kIndexBits == fingerprint) {
+					return unpack_index(entry);
+				}
+			}
+			return kNone;
+		}
+
+		bool contains(const uint64_t hash) const {
+			const uint64_t fingerprint = get_fingerprint(hash);
+			uint64_t slot = fingerprint & mask;
+			for (size_t probe = 0; probe < capacity; ++probe, slot = (slot + 1) & mask) {
+				uint64_t entry = entries[slot].load(std::memory_order_acquire);
+				if (entry == kEmpty) {
+					return false;
+				}
+				if (entry != kTombstone && entry >> kIndexBits == fingerprint) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		size_t slot_count() const {
+			return capacity;
+		}
+
+		// tombstones every entry in [first_slot, last_slot) whose index satisfies predicate, threads may split the
+		// slots between them; entries still waiting for assign() are kept
+		template <typename Predicate>
+		size_t erase_if(Predicate&& predicate, const size_t first_slot, const size_t last_slot) {
+			size_t erased = 0;
+			for (size_t slot = first_slot; slot < last_slot; ++slot) {
+				uint64_t entry = entries[slot].load(std::memory_order_acquire);
+				if (entry == kEmpty || entry == kTombstone || unpack_index(entry) == kNone || !predicate(unpack_index(entry))) {
+					continue;
+				}
+				if (entries[slot].compare_exchange_strong(entry, kTombstone, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+					++erased;
+				}
+			}
+			tombstone_count.fetch_add(erased, std::memory_order_relaxed);
+			return erased;
+		}
+
+		template <typename Predicate>
+		size_t erase_if(Predicate&& predicate) {
+			return erase_if(predicate, 0, capacity);
+		}
+
+		// not concurrent: makes room for count entries at half load, rebuilding also drops the tombstones
+		void reserve(const size_t count) {
+			size_t new_capacity = std::bit_ceil(std::max(kMinCapacity, 2 * count));
+			if (new_capacity <= capacity) {
+				if (tombstone_count.load(std::memory_order_relaxed) < capacity / 4) {
+					return;
+				}
+				new_capacity = capacity;
+			}
+			tombstone_count.store(0, std::memory_order_relaxed);
+			auto old_entries = std::move(entries);
+			size_t old_capacity = capacity;
+			entries = std::make_unique<std::atomic<uint64_t>[]>(new_capacity);
+			capacity = new_capacity;
+			mask = new_capacity - 1;
+			for (size_t i = 0; i < capacity; ++i) {
+				entries[i].store(kEmpty, std::memory_order_relaxed);
+			}
+			for (size_t i = 0; i < old_capacity; ++i) {
+				uint64_t entry = old_entries[i].load(std::memory_order_relaxed);
+				if (entry != kEmpty && entry != kTombstone) {
+					insert_unique(entry);
+				}
+			}
+		}
+
+		// not concurrent
+		void clear() {
+			tombstone_count.store(0, std::memory_order_relaxed);
+			for (size_t i = 0; i < capacity; ++i) {
+				entries[i].store(kEmpty, std::memory_order_relaxed);
+			}
+		}
+	};
+} // namespace noir
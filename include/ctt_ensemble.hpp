@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "ctt_node_manager.hpp"
+
+namespace noir::ctt {
+	enum class EnsembleMerge {
+		value, // the root move with the highest result value of any instance
+		votes, // the root move most instances picked, ties go to the higher mean value
+	};
+
+	// Root parallelism: K independent NodeManager instances searched on K threads, one per instance, merged at the root.
+	// Instances share nothing, so they only diverge through their configs (depth, mode, exploration, ...) or
+	// through the instance index passed to the expand function, e.g. as a move-ordering seed.
+	// Searches through get_task, beam instances are not driven.
+	template <typename State, typename StateEqual, typename StateHash, typename StateCanonicalize = NoCanonicalize, typename TranspositionTable = MapTranspositionTable>
+	class Ensemble {
+	    public:
+		using Manager = NodeManager<State, StateEqual, StateHash, StateCanonicalize, TranspositionTable>;
+
+	    private:
+		struct RootVote {
+			const State* state;
+			double value_sum;
+			double best_value;
+			size_t votes;
+		};
+
+		std::vector<std::unique_ptr<Manager>> managers;
+		EnsembleMerge merge = EnsembleMerge::votes;
+		StateEqual state_equal;
+		const State* result = nullptr;
+		double result_value = std::numeric_limits<double>::lowest();
+
+		void merge_results() {
+			std::vector<RootVote> root_votes;
+			for (std::unique_ptr<Manager>& manager : managers) {
+				const State* state = manager->get_result();
+				if (state == nullptr) {
+					continue;
+				}
+				double value = manager->get_result_value();
+				RootVote* vote = nullptr;
+				for (RootVote& root_vote : root_votes) {
+					if (state_equal(*root_vote.state, *state)) {
+						vote = &root_vote;
+						break;
+					}
+				}
+				if (vote == nullptr) {
+					root_votes.push_back({state, value, value, 1});
+				} else {
+					vote->value_sum += value;
+					vote->best_value = std::max(vote->best_value, value);
+					++vote->votes;
+				}
+			}
+			const RootVote* best = nullptr;
+			for (const RootVote& root_vote : root_votes) {
+				if (best == nullptr) {
+					best = &root_vote;
+				} else if (merge == EnsembleMerge::value) {
+					if (root_vote.best_value > best->best_value) {
+						best = &root_vote;
+					}
+				} else if (root_vote.votes > best->votes || (root_vote.votes == best->votes && root_vote.value_sum / root_vote.votes > best->value_sum / best->votes)) {
+					best = &root_vote;
+				}
+			}
+			result = best == nullptr ? nullptr : best->state;
+			result_value = best == nullptr ? std::numeric_limits<double>::lowest() : merge == EnsembleMerge::value ? best->best_value : best->value_sum / best->votes;
+		}
+
+		// one thread per instance taking tasks while keep_searching(Manager&, size_t tasks_taken) holds, then merges
+		template <typename ExpandFunc, typename KeepSearching>
+		size_t run_instances(ExpandFunc& expand_fn, const KeepSearching& keep_searching) {
+			std::vector<size_t> taken(managers.size());
+			auto search_instance = [&](const size_t index) {
+				Manager& manager = *managers[index];
+				do {
+					State* task = manager.get_task();
+					if (task == nullptr) {
+						break;
+					}
+					expand_fn(manager, *task, index);
+					manager.increment_depth_counter();
+					++taken[index];
+				} while (keep_searching(manager, taken[index]));
+			};
+			std::vector<std::thread> threads;
+			threads.reserve(managers.size());
+			for (size_t i = 1; i < managers.size(); ++i) {
+				threads.emplace_back(search_instance, i);
+			}
+			if (!managers.empty()) {
+				search_instance(0);
+			}
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+			merge_results();
+			size_t total = 0;
+			for (size_t count : taken) {
+				total += count;
+			}
+			return total;
+		}
+
+	    public:
+		explicit Ensemble(const size_t instance_count) {
+			managers.reserve(instance_count);
+			for (size_t i = 0; i < instance_count; ++i) {
+				managers.emplace_back(std::make_unique<Manager>());
+			}
+		}
+
+		size_t size() const {
+			return managers.size();
+		}
+
+		Manager& get_instance(const size_t index) {
+			return *managers[index];
+		}
+
+		void set_merge(const EnsembleMerge new_merge) {
+			merge = new_merge;
+		}
+
+		// stops every instance, see NodeManager::set_stop_token
+		void set_stop_token(const std::stop_token& token) {
+			for (std::unique_ptr<Manager>& manager : managers) {
+				manager->set_stop_token(token);
+			}
+		}
+
+		// every instance re-roots on its own tree, or resets when its best move was not the one played
+		void prepare_tree(const State& current_state) {
+			result = nullptr;
+			for (std::unique_ptr<Manager>& manager : managers) {
+				manager->prepare_tree(current_state);
+			}
+		}
+
+		// expand_fn(Manager&, State& task, size_t instance) generates the children of task through Manager::try_child
+		// and is called from every instance's thread at once. Each instance searches until the budget is spent and
+		// its depths are populated, or until it runs out of tasks. Returns the tasks taken by all instances.
+		template <typename Rep, typename Period, typename ExpandFunc>
+		size_t search(const std::chrono::duration<Rep, Period> budget, ExpandFunc&& expand_fn) {
+			auto deadline = std::chrono::steady_clock::now() + budget;
+			return run_instances(expand_fn, [deadline](Manager& manager, size_t) { return std::chrono::steady_clock::now() < deadline || !manager.are_depths_populated(); });
+		}
+
+		// same with a fixed budget of task_budget tasks per instance, at least one, so the work does not depend on timing
+		template <typename ExpandFunc>
+		size_t search(const size_t task_budget, ExpandFunc&& expand_fn) {
+			return run_instances(expand_fn, [task_budget](Manager&, const size_t taken) { return taken < task_budget; });
+		}
+
+		// the merged root move, points into the instance that contributed it until the next prepare_tree
+		const State* get_result() const {
+			return result;
+		}
+
+		// best value (EnsembleMerge::value) or mean value of the voters (EnsembleMerge::votes) of get_result()
+		double get_result_value() const {
+			return result_value;
+		}
+	};
+} // namespace noir::ctt
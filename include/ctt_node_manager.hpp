@@ -1,25 +1,146 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <deque>
+#include <fstream>
+#include <functional>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "concurrent_transposition_table.hpp"
+#include "mapped_file.hpp"
+#include "numa_topology.hpp"
 #include "priority_queue.hpp"
+#include "ring_buffer.hpp"
+#include "seqlock.hpp"
+#include "shared_transposition_table.hpp"
 
 namespace noir::ctt {
-	template <typename State, typename StateEqual, typename StateHash>
+	enum class SearchMode {
+		layered, // best-first per depth, depths visited round robin
+		mcts,	 // UCT selection from the root, children backpropagate their value
+		beam,	 // level-synchronous, the best beam_width children of a layer form the next layer
+		best_first, // one open list across depths ordered by value - step_cost * depth
+	};
+
+	// what an evaluate function may return instead of a plain value
+	struct Evaluation {
+		double value;
+		bool terminal = false; // never expanded, ends the search when stop_on_solution is set
+	};
+
+	enum class ValueBackup {
+		none,	 // a root move is judged by the single best leaf below it
+		max,	 // a node is worth its best child
+		negamax, // a node is worth minus its best child, values are from the view of the side that moved into the node
+	};
+
+	// default canonicalization hook, every state is its own canonical form
+	struct NoCanonicalize {
+		template <typename State>
+		static void operator()(State&) {}
+	};
+
+	// default dedup policy, a hash map for single-threaded use
+	// ConcurrentTranspositionTable provides the same interface for several threads inserting at once
+	class MapTranspositionTable {
+	    private:
+		std::unordered_map<uint64_t, uint32_t> table;
+
+	    public:
+		using Slot = std::unordered_map<uint64_t, uint32_t>::iterator;
+
+		static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+		std::pair<Slot, bool> try_emplace(const uint64_t hash, const uint32_t index) {
+			return table.try_emplace(hash, index);
+		}
+
+		static void assign(const Slot slot, const uint32_t index) {
+			slot->second = index;
+		}
+
+		void assign(const uint64_t hash, const uint32_t index) {
+			table.insert_or_assign(hash, index);
+		}
+
+		bool contains(const uint64_t hash) const {
+			return table.contains(hash);
+		}
+
+		size_t slot_count() const {
+			return table.bucket_count();
+		}
+
+		// erases in buckets [first_slot, last_slot), erasing never rehashes so a sweep can be split over several calls
+		template <typename Predicate>
+		size_t erase_if(Predicate&& predicate, const size_t first_slot, const size_t last_slot) {
+			size_t erased = 0;
+			for (size_t bucket = first_slot; bucket < last_slot; ++bucket) {
+				for (auto it = table.begin(bucket); it != table.end(bucket);) {
+					if (it->second == kNone || !predicate(it->second)) {
+						++it;
+						continue;
+					}
+					uint64_t hash = it->first;
+					++it;
+					table.erase(hash);
+					++erased;
+				}
+			}
+			return erased;
+		}
+
+		template <typename Predicate>
+		size_t erase_if(Predicate&& predicate) {
+			return std::erase_if(table, [&predicate](const auto& entry) { return entry.second != kNone && predicate(entry.second); });
+		}
+
+		void reserve(const size_t count) {
+			table.reserve(count);
+		}
+
+		void clear() {
+			table.clear();
+		}
+	};
+
+	// StateCanonicalize maps a state in place onto the representative of its symmetry class and may return the
+	// transform it applied. Only the hash sees the canonical copy: nodes keep the real state, so get_result and
+	// prepare_tree work on real moves and the transform needs no inverse.
+	// TranspositionTable is the dedup policy, mapping state hashes to Node::index.
+	template <typename State, typename StateEqual, typename StateHash, typename StateCanonicalize = NoCanonicalize, typename TranspositionTable = MapTranspositionTable>
 	class NodeManager {
 	    private:
 		static_assert(sizeof(State) >= sizeof(size_t));
 
 		struct Node {
+			static constexpr int8_t kUnknownHome = -1;
+
 			Node* parent;
 			State state;
+			uint32_t index; // position in NodeMemory, stable for the lifetime of the storage
+			uint32_t move_cursor; // where a partially expanded node resumes generating children
+			uint32_t chain_length; // forced states compressed into the edge from the parent, see NodeTreeConfig::compress_chains
 			bool pruned;
+			bool expanded;
+			bool terminal;
+			int8_t home; // NUMA node of the worker that created the node, it keeps it when recycled
 
 			const Node* get_first_parent() const {
 				if (parent == nullptr) {
@@ -40,14 +161,19 @@ namespace noir::ctt {
 			}
 		};
 
+		// allocate/deallocate/get are for the owning thread while no Cache is alive, workers go through a Cache each
 		class NodeMemory {
 		    private:
+			static constexpr size_t kCacheBatch = 64;
+
 			std::deque<Node> node_storage;
 			Node* free_head = nullptr;
 			size_t cursor = 0;
 			size_t free_count = 0;
+			std::mutex pool_mutex; // guards the pool while caches refill from and flush to it
+			std::atomic<size_t> live_caches = 0;
 
-			Node* allocate_raw() {
+			Node* allocate_raw(const int8_t home) {
 				Node* ret;
 				if (free_head != nullptr) {
 					ret = free_head;
@@ -59,13 +185,150 @@ namespace noir::ctt {
 				} else {
 					node_storage.emplace_back();
 					ret = &node_storage.back();
+					ret->index = static_cast<uint32_t>(node_storage.size() - 1);
+					ret->home = home;
 					++cursor;
 				}
 				return ret;
 			}
 
+			static void initialize(Node* node, Node* parent) {
+				node->pruned = false;
+				node->expanded = false;
+				node->terminal = false;
+				node->move_cursor = 0;
+				node->chain_length = 0;
+				node->parent = parent;
+			}
+
+			// count nodes linked through parent, taken out of the pool in one critical section
+			Node* take_batch(const size_t count, const int8_t home) {
+				std::lock_guard lock(pool_mutex);
+				Node* head = nullptr;
+				for (size_t i = 0; i < count; ++i) {
+					Node* node = allocate_raw(home);
+					node->parent = head;
+					head = node;
+				}
+				return head;
+			}
+
+			void give_back(Node* first, Node* last, const size_t count) {
+				std::lock_guard lock(pool_mutex);
+				last->parent = free_head;
+				free_head = first;
+				free_count += count;
+			}
+
 		    public:
+			// per-thread magazine of free nodes: allocate and deallocate only touch the pool when the magazine
+			// runs empty or grows past two batches, nodes held by a cache count as used
+			class Cache {
+			    private:
+				NodeMemory& memory;
+				Node* head = nullptr;
+				size_t count = 0;
+
+			    public:
+				explicit Cache(NodeMemory& owner)
+				    : memory(owner) {
+					memory.live_caches.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				Cache(const Cache&) = delete;
+				Cache& operator=(const Cache&) = delete;
+
+				~Cache() {
+					flush();
+					memory.live_caches.fetch_sub(1, std::memory_order_relaxed);
+				}
+
+				Node* allocate(Node* parent) {
+					if (head == nullptr) {
+						head = memory.take_batch(kCacheBatch, Node::kUnknownHome);
+						count = kCacheBatch;
+					}
+					Node* ret = head;
+					head = head->parent;
+					--count;
+					initialize(ret, parent);
+					return ret;
+				}
+
+				void deallocate(Node* node) {
+					node->pruned = true;
+					node->parent = head;
+					head = node;
+					if (++count < 2 * kCacheBatch) {
+						return;
+					}
+					Node* last = head;
+					for (size_t i = 1; i < kCacheBatch; ++i) {
+						last = last->parent;
+					}
+					Node* first = head;
+					head = last->parent;
+					count -= kCacheBatch;
+					memory.give_back(first, last, kCacheBatch);
+				}
+
+				// takes batches from the pool until at least wanted nodes are cached, nodes the pool creates for it
+				// are first touched by the calling thread, which runs on NUMA node home
+				void reserve(const size_t wanted, const int8_t home) {
+					while (count < wanted) {
+						Node* first = memory.take_batch(kCacheBatch, home);
+						Node* last = first;
+						while (last->parent != nullptr) {
+							last = last->parent;
+						}
+						last->parent = head;
+						head = first;
+						count += kCacheBatch;
+					}
+				}
+
+				// returns every cached node to the pool
+				void flush() {
+					if (head == nullptr) {
+						return;
+					}
+					Node* last = head;
+					while (last->parent != nullptr) {
+						last = last->parent;
+					}
+					memory.give_back(head, last, count);
+					head = nullptr;
+					count = 0;
+				}
+			};
+
+			// nodes freed by one thread without touching the pool, handed over in one piece by release
+			struct FreeList {
+				Node* head = nullptr;
+				Node* tail = nullptr;
+				size_t count = 0;
+
+				void push(Node* node) {
+					node->pruned = true;
+					node->parent = head;
+					head = node;
+					if (tail == nullptr) {
+						tail = node;
+					}
+					++count;
+				}
+			};
+
+			// the pool ends up as if the nodes of list had been deallocated here in push order
+			void release(FreeList& list) {
+				if (list.head != nullptr) {
+					give_back(list.head, list.tail, list.count);
+				}
+				list = FreeList{};
+			}
+
 			void reset() {
+				assert(live_caches.load(std::memory_order_relaxed) == 0);
 				free_head = nullptr;
 				cursor = 0;
 				free_count = node_storage.size();
@@ -83,10 +346,17 @@ namespace noir::ctt {
 				return size() >= limit;
 			}
 
+			size_t capacity() const {
+				return node_storage.size();
+			}
+
+			Node* get(const size_t index) {
+				return &node_storage[index];
+			}
+
 			Node* allocate(Node* parent) {
-				Node* ret = allocate_raw();
-				ret->pruned = false;
-				ret->parent = parent;
+				Node* ret = allocate_raw(Node::kUnknownHome);
+				initialize(ret, parent);
 				return ret;
 			}
 
@@ -98,6 +368,25 @@ namespace noir::ctt {
 			}
 		};
 
+	    public:
+		// the node pool type, exposed for the allocation benchmark
+		using Memory = NodeMemory;
+
+		// copy of the result and counters that other threads read through read_snapshot while the search runs
+		struct SearchSnapshot {
+			State result; // valid when has_result
+			bool has_result;
+			bool solved;
+			bool settled;
+			double result_value;
+			uint64_t node_count;
+			uint64_t searched;
+			uint64_t collision;
+			uint64_t shared_hit;
+			uint64_t bound_skip;
+		};
+
+	    private:
 		struct NodeValue {
 			Node* node;
 			double value;
@@ -111,28 +400,166 @@ namespace noir::ctt {
 
 		using NodeValuePriorityQueue = PriorityQueue<NodeValue, NodeValueCompare>;
 
+		struct OpenValue {
+			Node* node;
+			double value;
+			size_t depth;
+		};
+
+		struct OpenValueCompare {
+			static bool operator()(const OpenValue& left, const OpenValue& right) {
+				return left.value < right.value;
+			}
+		};
+
+		using OpenValuePriorityQueue = PriorityQueue<OpenValue, OpenValueCompare>;
+
 		struct NodeTreeConfig {
 			size_t depth = 7;
 			size_t prune_depth_limit = 0;
 			size_t node_limit = 100000; // soft limit
+			SearchMode mode = SearchMode::layered;
+			double exploration = 1.41; // UCT constant, scale with the evaluation range
+			size_t beam_width = 64;
+			size_t thread_count = 1;
+			size_t batch_size = 64; // tasks per expand_batch epoch
+			size_t pipeline_capacity = 1024; // slots of each expand_pipeline ring
+			// expand_beam_layer, expand_batch and expand_pipeline pin their workers to cpus spread over the NUMA nodes and
+			// sample how many task nodes they read from another node; beam and batch workers also keep a node arena each,
+			// first touched on their own node, that the children they generated are committed into, and tasks go to a
+			// worker on the node their node was created on. Node indices then depend on thread_count, so equally valued
+			// nodes may be ordered differently after a re-root
+			bool numa_aware = false;
+			// best_first: reported values are negated heuristics (higher is closer to the goal),
+			// so value - step_cost * depth orders the open list by f = g + h with unit edge cost step_cost
+			double step_cost = 1.0;
+			ValueBackup backup = ValueBackup::none;
+			bool stop_on_solution = false; // the first terminal child ends the search and fixes the path to it
+			// outside beam mode the bounded try_child drops children whose bound is below bound_cutoff, the default keeps
+			// all of them. Beam mode compares bounds against its own beam instead
+			double bound_cutoff = std::numeric_limits<double>::lowest();
+			// get_task ends the search once the best root child leads the second by early_stop_margin
+			// and holds early_stop_coverage of the frontier (of the root visits for mcts), checked every early_stop_interval tasks.
+			// expand_beam_layer checks before every layer, its frontier being the deepest open layer
+			bool early_stop = false;
+			double early_stop_margin = 1.0;
+			double early_stop_coverage = 0.5;
+			size_t early_stop_interval = 64;
+			// layered: a task with exactly one admissible child takes over the child's state and is queued again at its
+			// own depth, so forced moves do not use up depth. Skipped with negamax backup, where a chain flips the side to move
+			bool compress_chains = false;
+			// get_task (expand_beam_layer: every layer) publishes a SearchSnapshot every snapshot_interval tasks, 0 leaves it to publish_snapshot
+			size_t snapshot_interval = 0;
+		};
+
+		// per-node statistics indexed by Node::index, only kept for mcts or value backup
+		// child lists are intrusive through first_child/next_sibling
+		struct NodeStatistics {
+			static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+			std::vector<uint32_t> visits;
+			std::vector<double> value_sum;
+			std::vector<double> static_value;
+			std::vector<double> backed_value;
+			std::vector<uint32_t> best_child;
+			std::vector<uint32_t> first_child;
+			std::vector<uint32_t> next_sibling;
+			std::vector<uint8_t> resolved; // mcts: the subtree holds no task up to the current depth horizon
+
+			void resize(const size_t size) {
+				if (visits.size() < size) {
+					resolved.resize(size);
+					visits.resize(size);
+					value_sum.resize(size);
+					static_value.resize(size);
+					backed_value.resize(size);
+					best_child.resize(size, kNone);
+					first_child.resize(size, kNone);
+					next_sibling.resize(size, kNone);
+				}
+			}
+
+			void reset_node(const uint32_t index, const uint32_t visit_count, const double value) {
+				visits[index] = visit_count;
+				value_sum[index] = value;
+				static_value[index] = value;
+				backed_value[index] = value;
+				best_child[index] = kNone;
+				first_child[index] = kNone;
+				next_sibling[index] = kNone;
+				resolved[index] = 0;
+			}
+
+			void select_best_child(const uint32_t index) {
+				best_child[index] = kNone;
+				for (uint32_t i = first_child[index]; i != kNone; i = next_sibling[i]) {
+					if (best_child[index] == kNone || backed_value[i] > backed_value[best_child[index]]) {
+						best_child[index] = i;
+					}
+				}
+			}
+
+			void link(const uint32_t parent, const uint32_t child) {
+				next_sibling[child] = first_child[parent];
+				first_child[parent] = child;
+			}
+
+			double get_mean(const uint32_t index) const {
+				return visits[index] == 0 ? 0.0 : value_sum[index] / visits[index];
+			}
 		};
 
 		struct NodeCursor {
 			Node* cursor = nullptr;
 			Node* allocated_node = nullptr;
 			size_t depth = 0;
+			double value = 0; // what a layered task was queued with, lets expand_batch queue it again
+			bool chain_candidate = false; // the first admissible child of the current task is held back
+		};
+
+		// held back first child of a task, committed once a second child shows up or compressed into the task
+		struct PendingChild {
+			State state;
+			Evaluation evaluation;
+			uint64_t hash = 0;
+			size_t depth = 0;
+			Node* parent = nullptr;
+			bool active = false;
+		};
+
+		// pruning or re-rooting in progress, kept between calls so a stop request can interrupt it, see run_cleanup
+		struct CleanupProgress {
+			bool active = false;
+			size_t depth = 0;
+			size_t end = 0;
+			const Node* survivor = nullptr; // the only node kept at the first depth, nullptr once that depth is done
+			bool make_root = false;         // the survivor becomes the root
+			bool heap_taken = false;        // the entries of the heap being swept are in heap_buffer
+			size_t phase = 0;               // container of depth being swept, see NodeDepth::get_heap
+			bool table_phase = false;
+			size_t position = 0; // next element of the container being swept, or next table slot
+			std::vector<NodeValue> heap_buffer;
 		};
 
 		struct NodeDepth {
+			static constexpr size_t kHeapCount = 2; // unsearched and terminals, searched comes after them
+
 			NodeValuePriorityQueue unsearched;
+			NodeValuePriorityQueue terminals; // never handed out as tasks, still leaves get_best_node can pick
 			std::vector<Node*> searched;
 
+			NodeValuePriorityQueue& get_heap(const size_t heap) {
+				return heap == 0 ? unsearched : terminals;
+			}
+
 			void make_root() {
 				assert(size() == 1);
 				if (!searched.empty()) {
 					searched[0]->parent = nullptr;
-				} else {
+				} else if (!unsearched.empty()) {
 					unsearched.top().node->parent = nullptr;
+				} else {
+					terminals.top().node->parent = nullptr;
 				}
 			}
 
@@ -140,86 +567,329 @@ namespace noir::ctt {
 				unsearched.push({node, value});
 			}
 
+			// moves the top unsearched node, a terminal one, out of the way of get_task
+			void hold_terminal() {
+				terminals.push(unsearched.top());
+				unsearched.pop();
+			}
+
+			// the better of the unsearched and terminal tops, nullptr when both are empty
+			const NodeValue* get_best_leaf() const {
+				if (terminals.empty()) {
+					return unsearched.empty() ? nullptr : &unsearched.top();
+				}
+				if (unsearched.empty() || terminals.top().value > unsearched.top().value) {
+					return &terminals.top();
+				}
+				return &unsearched.top();
+			}
+
 			Node* get_unsearched_node() {
 				Node* ret = unsearched.top().node;
 				unsearched.pop();
+				ret->expanded = true;
 				searched.emplace_back(ret);
 				return ret;
 			}
 
 			size_t size() const {
-				return unsearched.size() + searched.size();
+				return unsearched.size() + terminals.size() + searched.size();
 			}
 
 			bool empty() const {
-				return unsearched.empty() && searched.empty();
+				return unsearched.empty() && terminals.empty() && searched.empty();
 			}
 
-			void cleanup(NodeMemory& memory) {
-				if (empty()) {
-					return;
+			void clear() {
+				unsearched.clear();
+				terminals.clear();
+				searched.clear();
+			}
+		};
+
+		struct ChildCandidate {
+			Node* parent;
+			uint64_t hash;
+			Evaluation evaluation;
+			State state;
+			size_t worker; // thread that generated it, picks the node arena with numa_aware
+		};
+
+		struct PipelineTask {
+			Node* node;
+			size_t depth;
+		};
+
+		// generated child on its way through expand_pipeline, hash and evaluation are filled in by an evaluator
+		struct PipelineChild {
+			Node* parent;
+			size_t depth;
+			uint64_t hash;
+			Evaluation evaluation;
+			State state;
+		};
+
+		// hashes the canonical form of a state, copying only when a canonicalization hook is set
+		struct StateHasher {
+			StateHash state_hash;
+			StateCanonicalize canonicalize;
+			State canonical_state;
+
+			uint64_t operator()(const State& state) {
+				if constexpr (std::is_same_v<StateCanonicalize, NoCanonicalize>) {
+					return state_hash(state);
+				} else {
+					canonical_state = state;
+					canonicalize(canonical_state);
+					return state_hash(canonical_state);
 				}
-				auto remove_orphans = [&memory]<typename Container, typename GetElement>(Container& container, GetElement get_element) {
-					for (size_t i = 0; i < container.size();) {
-						Node* node = get_element(container[i]);
-						if (node->parent->pruned) {
-							memory.deallocate(node);
-							container[i] = std::move(container.back());
-							container.pop_back();
+			}
+		};
+
+		// shared table hits skip evaluate_fn, which may return a double or an Evaluation
+		template <typename EvaluateFunc>
+		static Evaluation evaluate_state(SharedTranspositionTable* table, const uint64_t hash, State& state, EvaluateFunc& evaluate_fn, size_t& shared_hit_count) {
+			Evaluation evaluation;
+			if (table != nullptr && table->find(hash, evaluation.value, evaluation.terminal)) {
+				++shared_hit_count;
+				return evaluation;
+			}
+			auto result = evaluate_fn(state);
+			if constexpr (std::is_same_v<decltype(result), Evaluation>) {
+				evaluation = result;
+			} else {
+				evaluation.value = static_cast<double>(result);
+			}
+			if (table != nullptr) {
+				table->store(hash, evaluation.value, evaluation.terminal);
+			}
+			return evaluation;
+		}
+
+		static bool is_better_candidate(const ChildCandidate& left, const ChildCandidate& right) {
+			// hash and parent break ties so the selected layer does not depend on how parents were split between threads
+			if (left.evaluation.value != right.evaluation.value) {
+				return left.evaluation.value > right.evaluation.value;
+			}
+			if (left.hash != right.hash) {
+				return left.hash < right.hash;
+			}
+			return left.parent->index < right.parent->index;
+		}
+
+	    public:
+		// per-thread collector handed to the expand functions of expand_beam_layer and expand_batch, only reads the manager
+		class ChildSink {
+			friend class NodeManager;
+
+		    private:
+			const NodeManager& manager;
+			StateHasher state_hash;
+			Node* parent = nullptr;
+			bool beam = true; // expand_batch keeps every child instead of a beam
+			State scratch_state;
+			std::vector<ChildCandidate> candidates;
+			std::vector<const Node*> bound_skipped_parents;
+			size_t searched_count = 0;
+			size_t collision_count = 0;
+			size_t shared_hit_count = 0;
+			size_t bound_skip_count = 0;
+			size_t worker = 0;
+			NumaAccessSampler numa_sampler;
+			// values of the best beam_width distinct candidates since the first bounded try_child, worst on top
+			PriorityQueue<double, std::greater<double>> beam_floor;
+			std::unordered_set<uint64_t> floor_hashes;
+			bool tracking_floor = false;
+
+			explicit ChildSink(const NodeManager& owner)
+			    : manager(owner), state_hash(owner.state_hash) {}
+
+			// sorts only as far as needed to find width locally unique candidates, the rest is dropped
+			void select(const size_t width) {
+				std::vector<ChildCandidate> selected;
+				std::unordered_set<uint64_t> seen;
+				size_t sorted = 0;
+				while (selected.size() < width && sorted < candidates.size()) {
+					size_t next = std::min(candidates.size(), sorted + 2 * (width - selected.size()));
+					std::partial_sort(candidates.begin() + sorted, candidates.begin() + next, candidates.end(), is_better_candidate);
+					for (; sorted < next && selected.size() < width; ++sorted) {
+						if (seen.insert(candidates[sorted].hash).second) {
+							selected.emplace_back(std::move(candidates[sorted]));
 						} else {
-							++i;
+							++collision_count;
 						}
 					}
-				};
-				if (!unsearched.empty()) {
-					std::vector<NodeValue> data = unsearched.export_container();
-					remove_orphans(data, [](NodeValue& nv) { return nv.node; });
-					unsearched.import_container(std::move(data));
 				}
-				remove_orphans(searched, [](Node* node) { return node; });
+				candidates = std::move(selected);
 			}
 
-			void filter(const Node* survivor, NodeMemory& memory) {
-				if (empty()) {
+			// a candidate below this thread's beam_width best is also below the merged layer, so skipping it changes nothing
+			bool is_below_floor(const double bound) const {
+				return beam_floor.size() >= manager.config.beam_width && bound < beam_floor.top();
+			}
+
+			void raise_floor(const uint64_t hash, const double value) {
+				if (!tracking_floor || !floor_hashes.insert(hash).second) {
 					return;
 				}
-				auto remove_losers = [&]<typename Container, typename GetElement>(Container& container, GetElement get_element) {
-					for (size_t i = 0; i < container.size();) {
-						Node* node = get_element(container[i]);
-						if (node != survivor) {
-							memory.deallocate(node);
-							container[i] = std::move(container.back());
-							container.pop_back();
-						} else {
-							++i;
-						}
+				if (beam_floor.size() < manager.config.beam_width) {
+					beam_floor.push(value);
+				} else if (value > beam_floor.top()) {
+					beam_floor.pop();
+					beam_floor.push(value);
+				}
+			}
+
+			template <typename EvaluateFunc>
+			bool add_scratch_candidate(EvaluateFunc& evaluate_fn) {
+				uint64_t hash = state_hash(scratch_state);
+				if (manager.transposition_table.contains(hash)) {
+					++collision_count;
+					return false;
+				}
+				Evaluation evaluation = evaluate_state(manager.shared_table, hash, scratch_state, evaluate_fn, shared_hit_count);
+				++searched_count;
+				candidates.push_back({parent, hash, evaluation, scratch_state, worker});
+				raise_floor(hash, evaluation.value);
+				return true;
+			}
+
+		    public:
+			template <typename Move, typename ApplyFunc, typename EvaluateFunc>
+			bool try_child(const Move& move, ApplyFunc&& apply_fn, EvaluateFunc&& evaluate_fn) {
+				scratch_state = parent->state;
+				apply_fn(scratch_state, move);
+				return add_scratch_candidate(evaluate_fn);
+			}
+
+			// bound_fn(const State&) is an optimistic estimate of evaluate_fn, children that cannot reach the beam
+			// (or bound_cutoff in expand_batch) skip evaluate_fn
+			template <typename Move, typename ApplyFunc, typename BoundFunc, typename EvaluateFunc>
+			bool try_child(const Move& move, ApplyFunc&& apply_fn, BoundFunc&& bound_fn, EvaluateFunc&& evaluate_fn) {
+				tracking_floor = beam;
+				scratch_state = parent->state;
+				apply_fn(scratch_state, move);
+				double bound = static_cast<double>(bound_fn(static_cast<const State&>(scratch_state)));
+				if (beam ? is_below_floor(bound) : manager.is_below_cutoff(bound)) {
+					++bound_skip_count;
+					if (bound_skipped_parents.empty() || bound_skipped_parents.back() != parent) {
+						bound_skipped_parents.emplace_back(parent);
 					}
-				};
-				if (!unsearched.empty()) {
-					std::vector<NodeValue> data = unsearched.export_container();
-					remove_losers(data, [](NodeValue& nv) { return nv.node; });
-					unsearched.import_container(std::move(data));
+					return false;
 				}
-				remove_losers(searched, [](Node* node) { return node; });
+				return add_scratch_candidate(evaluate_fn);
 			}
+		};
 
-			void clear() {
-				unsearched.clear();
-				searched.clear();
+		// generate stage of expand_pipeline, hands the children of a task round robin to the evaluator rings
+		class GenerateSink {
+			friend class NodeManager;
+
+		    private:
+			std::deque<SpscRing<PipelineChild>>& rings;
+			Node* parent = nullptr;
+			size_t parent_depth = 0;
+			size_t next_ring = 0;
+			size_t generated_count = 0;
+
+			explicit GenerateSink(std::deque<SpscRing<PipelineChild>>& evaluator_rings)
+			    : rings(evaluator_rings) {}
+
+		    public:
+			// queues the child for evaluation, the commit stage still drops it when it is a duplicate
+			template <typename Move, typename ApplyFunc>
+			void try_child(const Move& move, ApplyFunc&& apply_fn) {
+				PipelineChild child = {parent, parent_depth, 0, {}, parent->state};
+				apply_fn(child.state, move);
+				for (size_t attempt = 1; !rings[next_ring].try_push(std::move(child)); ++attempt) {
+					next_ring = (next_ring + 1) % rings.size();
+					if (attempt % rings.size() == 0) {
+						std::this_thread::yield();
+					}
+				}
+				next_ring = (next_ring + 1) % rings.size();
+				++generated_count;
 			}
 		};
 
+	    private:
+		// snapshot layout: header | depths | nodes | table | states (aligned to State)
+		// nodes are stored depth by depth so a parent index is always smaller than its children's,
+		// each node's chain states precede its own state
+		struct SnapshotHeader {
+			uint64_t magic;
+			uint64_t state_size;
+			uint64_t depth_count;
+			uint64_t node_count;
+			uint64_t table_count;
+			uint64_t cursor_depth;
+			uint64_t total_searched;
+			uint64_t total_collision;
+			uint64_t chain_state_count;
+			uint64_t solution; // node, kNoParent without one
+			double solution_value;
+		};
+
+		struct SnapshotDepth {
+			uint64_t unsearched_count;
+			uint64_t terminal_count;
+			uint64_t searched_count;
+		};
+
+		struct SnapshotNode {
+			uint64_t parent;
+			double value; // static evaluation
+			uint64_t chain_length;
+			uint32_t move_cursor;
+			uint32_t terminal;
+		};
+
+		struct SnapshotEntry {
+			uint64_t hash;
+			uint64_t node;
+		};
+
+		static constexpr uint64_t kSnapshotMagic = 0x33544e53'5454434e; // "NCTTSNT3"
+		static constexpr uint64_t kNoParent = std::numeric_limits<uint64_t>::max();
+
+		static size_t get_snapshot_states_offset(const SnapshotHeader& header) {
+			size_t offset = sizeof(SnapshotHeader) + header.depth_count * sizeof(SnapshotDepth) + header.node_count * sizeof(SnapshotNode) + header.table_count * sizeof(SnapshotEntry);
+			constexpr size_t alignment = alignof(State) > alignof(uint64_t) ? alignof(State) : alignof(uint64_t);
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
 	    private:
 		NodeMemory memory;
 		NodeCursor node_cursor;
+		State scratch_state;
 		std::vector<NodeDepth> depths;
 		NodeTreeConfig config;
-		size_t total_searched;
-		size_t total_collision;
+		size_t total_searched = 0;
+		size_t total_collision = 0;
+		size_t total_shared_hit = 0;
+		size_t total_bound_skip = 0;
 
-		std::unordered_map<uint64_t, Node*> transposition_table;
+		NodeStatistics statistics;
+		OpenValuePriorityQueue open_list;
+
+		TranspositionTable transposition_table;
+		SharedTranspositionTable* shared_table = nullptr;
+		Node* solution = nullptr;
+		double solution_value = 0;
+		size_t tasks_since_decision_check = 0;
+		bool decision_settled = false;
+		size_t tasks_since_snapshot = 0;
+		double batch_children_per_task = 0; // of the last expand_batch epoch, sizes the next one against node_limit
+		SeqLock<SearchSnapshot> snapshot;
+		PendingChild pending_child;
+		typename NodeMemory::Cache* commit_arena = nullptr; // where commits allocate, nullptr for the pool
+		size_t total_numa_local = 0;
+		size_t total_numa_remote = 0;
+		CleanupProgress cleanup;
+		std::stop_token stop_token;
+		std::vector<std::vector<State>> chains; // indexed by Node::index, the first chain_length entries are valid
 		StateEqual state_equal;
-		StateHash state_hash;
+		StateHasher state_hash;
 
 		size_t get_first_active_depth_index() const {
 			for (size_t i = 0; i < depths.size(); ++i) {
@@ -244,80 +914,810 @@ namespace noir::ctt {
 			if (index == std::numeric_limits<size_t>::max()) {
 				return nullptr;
 			}
-			if (depths[index].unsearched.empty()) {
-				return nullptr;
-			}
-			return depths[index].unsearched.top().node;
+			const NodeValue* best = depths[index].get_best_leaf();
+			return best == nullptr ? nullptr : best->node;
 		}
 
 		Node* get_root() {
 			std::vector<Node*>& searched_vec = depths.front().searched;
 			if (searched_vec.empty()) {
+				// mcts and best_first expand nodes in place, so a re-rooted tree keeps its root in unsearched
+				if ((config.mode == SearchMode::mcts || config.mode == SearchMode::best_first) && depths.front().unsearched.size() == 1) {
+					return depths.front().unsearched.top().node;
+				}
 				return nullptr;
 			}
 			assert(searched_vec.size() == 1);
 			return searched_vec[0];
 		}
 
-		void reset(const State& current_state) {
-			memory.reset();
-			transposition_table.clear();
-			for (NodeDepth& depth : depths) {
-				depth.searched.clear();
-				depth.unsearched.clear();
-			}
-			depths.resize(config.depth + 1);
-			Node* root = memory.allocate(nullptr);
-			root->state = current_state;
-			depths.front().push(root, 0);
-		}
-
-		void cleanup(const size_t start, const size_t end) {
-			for (size_t i = start; i < end; ++i) {
-				NodeDepth& depth = depths[i];
-				depth.cleanup(memory);
+		const Node* get_most_visited_root_child() {
+			Node* root = get_root();
+			if (root == nullptr) {
+				return nullptr;
 			}
-			for (auto it = transposition_table.begin(); it != transposition_table.end();) {
-				if (it->second->pruned) {
-					it = transposition_table.erase(it);
-				} else {
-					++it;
+			const Node* best = nullptr;
+			for (uint32_t i = statistics.first_child[root->index]; i != NodeStatistics::kNone; i = statistics.next_sibling[i]) {
+				const Node* child = memory.get(i);
+				if (best == nullptr || statistics.visits[i] > statistics.visits[best->index] || (statistics.visits[i] == statistics.visits[best->index] && statistics.get_mean(i) > statistics.get_mean(best->index))) {
+					best = child;
 				}
 			}
+			return best;
 		}
 
-		bool prune() {
-			if (config.prune_depth_limit == 0) {
-				return false;
+		const Node* get_best_root_child() {
+			if (solution != nullptr) {
+				return solution->get_first_parent();
 			}
+			if (config.mode == SearchMode::mcts) {
+				return get_most_visited_root_child();
+			}
+			if (config.backup != ValueBackup::none) {
+				return get_backed_up_node_at(1);
+			}
+			const Node* best_leaf = get_best_node();
+			if (best_leaf == nullptr) {
+				return nullptr;
+			}
+			return best_leaf->get_first_parent();
+		}
 
-			size_t first_active_depth_index = get_first_active_depth_index();
-			size_t last_active_depth_index = get_last_active_depth_index();
-
-			if (first_active_depth_index > config.prune_depth_limit) {
-				return false;
+		// child lists reference nodes by index, so they are rebuilt whenever cleanup may have freed nodes
+		void rebuild_links() {
+			statistics.resize(memory.capacity());
+			for (NodeDepth& depth : depths) {
+				for (size_t heap = 0; heap < NodeDepth::kHeapCount; ++heap) {
+					for (const NodeValue& node_value : depth.get_heap(heap).get_container()) {
+						statistics.first_child[node_value.node->index] = NodeStatistics::kNone;
+					}
+				}
+				for (const Node* node : depth.searched) {
+					statistics.first_child[node->index] = NodeStatistics::kNone;
+				}
 			}
-			if (first_active_depth_index == last_active_depth_index) {
-				return false;
+			for (size_t i = 1; i < depths.size(); ++i) {
+				for (size_t heap = 0; heap < NodeDepth::kHeapCount; ++heap) {
+					for (const NodeValue& node_value : depths[i].get_heap(heap).get_container()) {
+						statistics.link(node_value.node->parent->index, node_value.node->index);
+					}
+				}
+				for (const Node* node : depths[i].searched) {
+					statistics.link(node->parent->index, node->index);
+				}
 			}
-			if (last_active_depth_index == std::numeric_limits<size_t>::max()) {
-				throw std::runtime_error("node_limit is too low"); // maybe can remove if never triggers
+			if (config.backup != ValueBackup::none) {
+				// deepest first so every child is final before its parent is computed
+				const double sign = get_backup_sign();
+				auto recompute = [&](const uint32_t index) {
+					statistics.select_best_child(index);
+					uint32_t best = statistics.best_child[index];
+					statistics.backed_value[index] = best == NodeStatistics::kNone ? statistics.static_value[index] : sign * statistics.backed_value[best];
+				};
+				for (size_t i = depths.size(); i-- > 0;) {
+					for (size_t heap = 0; heap < NodeDepth::kHeapCount; ++heap) {
+						for (const NodeValue& node_value : depths[i].get_heap(heap).get_container()) {
+							recompute(node_value.node->index);
+						}
+					}
+					for (const Node* node : depths[i].searched) {
+						recompute(node->index);
+					}
+				}
 			}
+		}
 
-			size_t first_and_last_depth_index_diff = last_active_depth_index - first_active_depth_index;
-			const Node* best_node = depths[last_active_depth_index].unsearched.top().node;
-			best_node = best_node->get_parent_at(first_and_last_depth_index_diff);
+		bool is_tracking_links() const {
+			return config.mode == SearchMode::mcts || config.backup != ValueBackup::none;
+		}
 
-			NodeDepth& first_active_depth = depths[first_active_depth_index];
-			first_active_depth.filter(best_node, memory);
+		double get_backup_sign() const {
+			return config.backup == ValueBackup::negamax ? -1.0 : 1.0;
+		}
+
+		// child's backed value changed from old_value, fixes best_child and backed_value of its ancestors as far as they change
+		void update_backup(const Node* child, double old_value) {
+			const double sign = get_backup_sign();
+			for (; child->parent != nullptr; child = child->parent) {
+				uint32_t parent_index = child->parent->index;
+				uint32_t child_index = child->index;
+				uint32_t best = statistics.best_child[parent_index];
+				if (best == child_index) {
+					if (statistics.backed_value[child_index] < old_value) {
+						statistics.select_best_child(parent_index);
+					}
+				} else if (best == NodeStatistics::kNone || statistics.backed_value[child_index] > statistics.backed_value[best]) {
+					statistics.best_child[parent_index] = child_index;
+				} else {
+					return;
+				}
+				double parent_value = sign * statistics.backed_value[statistics.best_child[parent_index]];
+				old_value = statistics.backed_value[parent_index];
+				if (parent_value == old_value) {
+					return;
+				}
+				statistics.backed_value[parent_index] = parent_value;
+			}
+		}
+
+		// follows the best backed-up children from the root down to depth
+		const Node* get_backed_up_node_at(const size_t depth) {
+			const Node* node = get_root();
+			for (size_t i = 0; i < depth && node != nullptr; ++i) {
+				uint32_t best = statistics.best_child[node->index];
+				node = best == NodeStatistics::kNone ? nullptr : memory.get(best);
+			}
+			return node;
+		}
+
+		double get_open_value(const double value, const size_t depth) const {
+			return value - config.step_cost * static_cast<double>(depth);
+		}
+
+		// the open list can hold freed nodes after cleanup, so it is rebuilt from the depths instead of filtered
+		void rebuild_open_list() {
+			std::vector<OpenValue> data = open_list.export_container();
+			data.clear();
+			for (size_t i = 0; i + 1 < depths.size(); ++i) {
+				for (const NodeValue& node_value : depths[i].unsearched.get_container()) {
+					if (!node_value.node->expanded && !node_value.node->terminal) {
+						data.push_back({node_value.node, get_open_value(node_value.value, i), i});
+					}
+				}
+			}
+			open_list.import_container(std::move(data));
+		}
+
+		State* get_best_first_task() {
+			if (solution != nullptr) {
+				return nullptr;
+			}
+			if (memory.is_limit_reached(config.node_limit)) {
+				if (!prune()) {
+					return nullptr;
+				}
+			}
+			if (open_list.empty()) {
+				return nullptr;
+			}
+			OpenValue top = open_list.top();
+			open_list.pop();
+			top.node->expanded = true;
+			node_cursor.cursor = top.node;
+			node_cursor.depth = top.depth;
+			return &top.node->state;
+		}
+
+		void add_child(Node* node, const size_t depth, const double value, const bool terminal) {
+			node->terminal = terminal;
+			depths[depth].push(node, value);
+			if (is_tracking_links()) {
+				track_child(node, value);
+			}
+			if (config.mode == SearchMode::mcts) {
+				backpropagate(node, value);
+			} else if (config.mode == SearchMode::best_first && !terminal && depth + 1 < depths.size()) {
+				open_list.push({node, get_open_value(value, depth), depth});
+			}
+			if (terminal && config.stop_on_solution && solution == nullptr) {
+				solution = node;
+				solution_value = value;
+			}
+		}
+
+		void track_child(Node* node, const double value) {
+			statistics.resize(memory.capacity());
+			statistics.reset_node(node->index, 1, value);
+			statistics.link(node->parent->index, node->index);
+			if (config.backup != ValueBackup::none) {
+				update_backup(node, std::numeric_limits<double>::lowest());
+			}
+		}
+
+		bool is_compressing_chains() const {
+			return config.compress_chains && config.mode == SearchMode::layered && config.backup != ValueBackup::negamax;
+		}
+
+		// the state one move below the parent, the front of the chain when forced moves were compressed into the edge
+		const State& get_edge_state(const Node* node) const {
+			return node->chain_length == 0 ? node->state : chains[node->index].front();
+		}
+
+		Node* allocate_node(Node* parent) {
+			return commit_arena != nullptr ? commit_arena->allocate(parent) : memory.allocate(parent);
+		}
+
+		// cpu of worker when numa_aware, -1 leaves the thread unpinned
+		int get_worker_cpu(const size_t worker) const {
+			return config.numa_aware ? NumaTopology::get().get_worker_cpu(worker) : -1;
+		}
+
+		// NUMA node worker is pinned to when numa_aware
+		int8_t get_worker_home(const size_t worker) const {
+			int node = config.numa_aware ? NumaTopology::get().get_node_of_cpu(get_worker_cpu(worker)) : -1;
+			return node >= 0 && node <= std::numeric_limits<int8_t>::max() ? static_cast<int8_t>(node) : Node::kUnknownHome;
+		}
+
+		// The worker expanding each task. With numa_aware a task goes to the least loaded worker pinned to the home
+		// of its node while those workers are below their share of the tasks, and to the least loaded worker
+		// otherwise, so a subtree stays on its node without leaving the other nodes idle. Round robin without.
+		template <typename TaskNode>
+		std::vector<size_t> route_tasks(const size_t task_count, const size_t thread_count, TaskNode&& task_node) const {
+			std::vector<size_t> owners(task_count);
+			if (!config.numa_aware) {
+				for (size_t i = 0; i < task_count; ++i) {
+					owners[i] = i % thread_count;
+				}
+				return owners;
+			}
+			std::vector<int8_t> homes(thread_count);
+			for (size_t worker = 0; worker < thread_count; ++worker) {
+				homes[worker] = get_worker_home(worker);
+			}
+			const size_t share = (task_count + thread_count - 1) / thread_count;
+			std::vector<size_t> loads(thread_count);
+			for (size_t i = 0; i < task_count; ++i) {
+				const int8_t home = task_node(i)->home;
+				size_t owner = thread_count;
+				for (size_t worker = 0; worker < thread_count; ++worker) {
+					if (homes[worker] == home && loads[worker] < share && (owner == thread_count || loads[worker] < loads[owner])) {
+						owner = worker;
+					}
+				}
+				if (owner == thread_count) {
+					owner = std::min_element(loads.begin(), loads.end()) - loads.begin();
+				}
+				owners[i] = owner;
+				++loads[owner];
+			}
+			return owners;
+		}
+
+		// on the worker's thread once it is pinned
+		void bind_worker(ChildSink& sink, const size_t worker) const {
+			sink.worker = worker;
+			if (config.numa_aware) {
+				sink.numa_sampler.node = NumaTopology::get().get_current_node();
+			}
+		}
+
+		void add_worker_counts(const ChildSink& sink) {
+			total_numa_local += sink.numa_sampler.local_count;
+			total_numa_remote += sink.numa_sampler.remote_count;
+		}
+
+		// One node arena per worker with numa_aware, none otherwise. Workers reserve their arena on their own node,
+		// the caller commits into it and whatever is left goes back to the pool when the arenas are destroyed.
+		// Recycled nodes may sit on any node, route_tasks sends their expansion to where Node::home says they are.
+		struct WorkerArenas {
+			std::vector<std::unique_ptr<typename NodeMemory::Cache>> caches;
+			std::atomic<size_t> turn = 0;
+
+			WorkerArenas(NodeMemory& memory, const size_t thread_count, const bool numa_aware) {
+				for (size_t i = 0; numa_aware && i < thread_count; ++i) {
+					caches.emplace_back(std::make_unique<typename NodeMemory::Cache>(memory));
+				}
+			}
+
+			// workers reserve one after another in index order, so the pool hands out the same nodes every run
+			void reserve(const size_t worker, const size_t wanted, const int8_t home) {
+				if (caches.empty()) {
+					return;
+				}
+				while (turn.load(std::memory_order_acquire) != worker) {
+					std::this_thread::yield();
+				}
+				caches[worker]->reserve(wanted, home);
+				turn.store(worker + 1, std::memory_order_release);
+			}
+
+			typename NodeMemory::Cache* get(const size_t worker) {
+				return caches.empty() ? nullptr : caches[worker].get();
+			}
+		};
+
+		void commit_pending_child() {
+			pending_child.active = false;
+			Node* node = allocate_node(pending_child.parent);
+			node->state = pending_child.state;
+			transposition_table.assign(pending_child.hash, node->index);
+			++total_searched;
+			add_child(node, pending_child.depth + 1, pending_child.evaluation.value, pending_child.evaluation.terminal);
+		}
+
+		// commits scratch_state as a child of the current task unless it is a duplicate
+		template <typename EvaluateFunc>
+		bool add_scratch_child(EvaluateFunc& evaluate_fn) {
+			uint64_t hash = state_hash(scratch_state);
+			auto [slot, inserted] = transposition_table.try_emplace(hash, TranspositionTable::kNone);
+			if (!inserted) {
+				++total_collision;
+				return false;
+			}
+			Evaluation evaluation = evaluate_state(shared_table, hash, scratch_state, evaluate_fn, total_shared_hit);
+			commit_child(slot, hash, scratch_state, evaluation);
+			return true;
+		}
+
+		// state passed the table as slot, it becomes a child of the current task or is held back as a chain candidate
+		void commit_child(const typename TranspositionTable::Slot slot, const uint64_t hash, const State& state, const Evaluation& evaluation) {
+			if (node_cursor.chain_candidate) {
+				node_cursor.chain_candidate = false;
+				TranspositionTable::assign(slot, node_cursor.cursor->index);
+				pending_child = {state, evaluation, hash, node_cursor.depth, node_cursor.cursor, true};
+				return;
+			}
+			if (pending_child.active) {
+				commit_pending_child();
+			}
+			node_cursor.allocated_node = allocate_node(node_cursor.cursor);
+			node_cursor.allocated_node->state = state;
+			TranspositionTable::assign(slot, node_cursor.allocated_node->index);
+			report_result(evaluation.value, evaluation.terminal);
+		}
+
+		// runs fn(thread_index) for every thread index, index 0 on the calling thread
+		template <typename ThreadFunc>
+		static void run_threads(const size_t thread_count, ThreadFunc&& fn) {
+			if (thread_count == 1) {
+				fn(0);
+				return;
+			}
+			std::vector<std::thread> threads;
+			threads.reserve(thread_count - 1);
+			for (size_t i = 1; i < thread_count; ++i) {
+				threads.emplace_back(fn, i);
+			}
+			fn(0);
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+		}
+
+		// only the caller knows which children can never matter: a child below the current best can still become the
+		// best after a re-root, so the tree itself gives no safe cutoff
+		bool is_below_cutoff(const double bound) const {
+			return bound < config.bound_cutoff;
+		}
+
+		// the task had a single admissible child: the task node moves onto it and goes back into its depth
+		void compress_pending_child() {
+			pending_child.active = false;
+			Node* node = pending_child.parent;
+			NodeDepth& depth = depths[pending_child.depth];
+			// the task is the last one searched, except within expand_batch
+			auto it = std::find(depth.searched.rbegin(), depth.searched.rend(), node);
+			assert(it != depth.searched.rend());
+			depth.searched.erase(std::next(it).base());
+			chains.resize(memory.capacity());
+			std::vector<State>& chain = chains[node->index];
+			chain.resize(node->chain_length);
+			chain.emplace_back(std::move(node->state));
+			++node->chain_length;
+			node->state = std::move(pending_child.state);
+			node->expanded = false;
+			node->terminal = pending_child.evaluation.terminal;
+			++total_searched;
+			depth.push(node, pending_child.evaluation.value);
+			if (config.backup != ValueBackup::none) {
+				double old_value = statistics.backed_value[node->index];
+				statistics.static_value[node->index] = pending_child.evaluation.value;
+				statistics.backed_value[node->index] = pending_child.evaluation.value;
+				update_backup(node, old_value);
+			}
+			if (node->terminal && config.stop_on_solution && solution == nullptr) {
+				solution = node;
+				solution_value = pending_child.evaluation.value;
+			}
+		}
+
+		// a held back child is only known to be the single one once its task is over
+		void flush_pending_child() {
+			if (pending_child.active) {
+				compress_pending_child();
+			}
+		}
+
+		// current_state was reached through the first count states of the chain leading to child, the root takes
+		// it over and child keeps the rest of its chain, every depth stays where it is
+		void enter_chain(Node* root, Node* child, const size_t count, const State& current_state) {
+			std::vector<State>& chain = chains[child->index];
+			chain.erase(chain.begin(), chain.begin() + static_cast<std::ptrdiff_t>(count));
+			child->chain_length -= static_cast<uint32_t>(count);
+			root->state = current_state;
+			start_cleanup(1, depths.size(), child, false);
+		}
+
+		void backpropagate(Node* node, const double value) {
+			for (Node* ancestor = node->parent; ancestor != nullptr; ancestor = ancestor->parent) {
+				++statistics.visits[ancestor->index];
+				statistics.value_sum[ancestor->index] += value;
+			}
+		}
 
-			cleanup(first_active_depth_index + 1, last_active_depth_index + 1);
+		// a terminal, dead-end or horizon node has no task, neither does a parent whose every child is resolved
+		void mark_resolved(const Node* node) {
+			for (; node != nullptr; node = node->parent) {
+				statistics.resolved[node->index] = 1;
+				if (node->parent == nullptr) {
+					return;
+				}
+				for (uint32_t i = statistics.first_child[node->parent->index]; i != NodeStatistics::kNone; i = statistics.next_sibling[i]) {
+					if (statistics.resolved[i] == 0) {
+						return;
+					}
+				}
+			}
+		}
+
+		// Walks down by UCT until a node that has not been expanded yet. A walk ending on a terminal, dead-end or
+		// horizon node backs up that node's value and marks it resolved. After kSelectAttempts such walks the
+		// resolved children are passed over, so every further walk finds a task or resolves another node, and
+		// nullptr means the root is resolved.
+		State* get_mcts_task() {
+			constexpr size_t kSelectAttempts = 16;
+			if (solution != nullptr) {
+				return nullptr;
+			}
+			if (memory.is_limit_reached(config.node_limit)) {
+				return nullptr;
+			}
+			Node* root = get_root();
+			if (root == nullptr) {
+				return nullptr;
+			}
+			statistics.resize(memory.capacity());
+			for (size_t attempt = 0; statistics.resolved[root->index] == 0; ++attempt) {
+				const bool skip_resolved = attempt >= kSelectAttempts;
+				Node* node = root;
+				size_t depth = 0;
+				bool dead_end = false;
+				while (node->expanded) {
+					Node* best = nullptr;
+					double best_score = std::numeric_limits<double>::lowest();
+					double log_visits = std::log(static_cast<double>(statistics.visits[node->index]) + 1.0);
+					for (uint32_t i = statistics.first_child[node->index]; i != NodeStatistics::kNone; i = statistics.next_sibling[i]) {
+						if (skip_resolved && statistics.resolved[i] != 0) {
+							continue;
+						}
+						double score = statistics.get_mean(i) + config.exploration * std::sqrt(log_visits / (statistics.visits[i] + 1.0));
+						if (score > best_score) {
+							best_score = score;
+							best = memory.get(i);
+						}
+					}
+					if (best == nullptr) {
+						dead_end = true;
+						break;
+					}
+					node = best;
+					++depth;
+				}
+				if (dead_end && statistics.first_child[node->index] != NodeStatistics::kNone) {
+					// only passed-over children left
+					mark_resolved(node);
+					continue;
+				}
+				if (dead_end || node->terminal || depth + 1 >= depths.size()) {
+					// terminal, expanded without admissible children or at the depth horizon, the node acts as its own rollout
+					double value = statistics.get_mean(node->index);
+					++statistics.visits[node->index];
+					statistics.value_sum[node->index] += value;
+					backpropagate(node, value);
+					mark_resolved(node);
+					continue;
+				}
+				node->expanded = true;
+				node_cursor.cursor = node;
+				node_cursor.depth = depth;
+				return &node->state;
+			}
+			return nullptr;
+		}
+
+		void reset(const State& current_state) {
+			memory.reset();
+			transposition_table.clear();
+			transposition_table.reserve(config.node_limit);
+			for (NodeDepth& depth : depths) {
+				depth.clear();
+			}
+			depths.resize(config.depth + 1);
+			Node* root = memory.allocate(nullptr);
+			root->state = current_state;
+			depths.front().push(root, 0);
+			if (is_tracking_links()) {
+				statistics.resize(memory.capacity());
+				statistics.reset_node(root->index, 0, 0);
+			}
+			open_list.clear();
+			solution = nullptr;
+			pending_child.active = false;
+			if (config.mode == SearchMode::best_first) {
+				open_list.push({root, 0, 0});
+			}
+		}
+
+		static constexpr size_t kCleanupChunk = 256; // nodes or table slots between stop checks
+		static constexpr size_t kParallelCleanupMinimum = 1 << 14; // fewer nodes left are swept on the calling thread
+
+		bool is_stop_requested() const {
+			return stop_token.stop_requested();
+		}
+
+		// queues the removal of everything but survivor at depth start and of the orphans this leaves in (start, end)
+		void start_cleanup(const size_t start, const size_t end, const Node* survivor, const bool make_root) {
+			cleanup.active = true;
+			cleanup.depth = start;
+			cleanup.end = end;
+			cleanup.survivor = survivor;
+			cleanup.make_root = make_root;
+			cleanup.heap_taken = false;
+			cleanup.phase = 0;
+			cleanup.table_phase = false;
+			cleanup.position = 0;
+		}
+
+		// sweeps container from cleanup.position on, false when a stop request came first
+		template <typename Container, typename GetElement>
+		bool sweep(Container& container, GetElement get_element, const bool interruptible) {
+			size_t steps = 0;
+			while (cleanup.position < container.size()) {
+				if (interruptible && ++steps % kCleanupChunk == 0 && is_stop_requested()) {
+					return false;
+				}
+				Node* node = get_element(container[cleanup.position]);
+				if (cleanup.survivor != nullptr ? node != cleanup.survivor : node->parent->pruned) {
+					memory.deallocate(node);
+					container[cleanup.position] = std::move(container.back());
+					container.pop_back();
+				} else {
+					++cleanup.position;
+				}
+			}
+			cleanup.position = 0;
 			return true;
 		}
 
+		// whether node at depth goes, judged against the depth the cleanup is at: everything but the survivor there,
+		// below it whatever descends from a node removed there
+		bool is_doomed(const Node* node, const size_t depth) const {
+			for (size_t i = cleanup.depth; i < depth; ++i) {
+				node = node->parent;
+			}
+			return cleanup.survivor != nullptr ? node != cleanup.survivor : node->parent->pruned;
+		}
+
+		// Sweeps the depths the cleanup has left in one go on config.thread_count threads, false when a stop request
+		// came first. The first pass only reads: it marks the nodes to remove by walking up to the current depth, so
+		// depths do not wait for each other, and a stop drops its marks. The second pass is not interrupted: every
+		// heap and searched list is swept by one thread into its own free list, exactly as sweep would, and the lists
+		// are merged into the pool in depth order, so the tree and the pool come out as from the serial sweep.
+		bool sweep_parallel(const bool interruptible) {
+			struct SweepTask {
+				size_t depth;
+				size_t phase; // as CleanupProgress::phase
+				std::vector<char> doomed;
+				typename NodeMemory::FreeList freed;
+			};
+			constexpr size_t kMarkChunk = 16 * kCleanupChunk;
+			auto get_node = [this](const SweepTask& task, const size_t i) {
+				NodeDepth& depth = depths[task.depth];
+				return task.phase == NodeDepth::kHeapCount ? depth.searched[i] : depth.get_heap(task.phase).get_container()[i].node;
+			};
+			std::vector<SweepTask> tasks;
+			std::vector<std::pair<size_t, size_t>> chunks; // task and first element
+			for (size_t depth = cleanup.depth; depth < cleanup.end; ++depth) {
+				for (size_t phase = 0; phase <= NodeDepth::kHeapCount; ++phase) {
+					size_t size = phase == NodeDepth::kHeapCount ? depths[depth].searched.size() : depths[depth].get_heap(phase).size();
+					for (size_t first = 0; first < size; first += kMarkChunk) {
+						chunks.emplace_back(tasks.size(), first);
+					}
+					tasks.push_back({depth, phase, std::vector<char>(size), {}});
+				}
+			}
+			const size_t thread_count = std::min(config.thread_count, chunks.size());
+			std::atomic<size_t> next_chunk = 0;
+			std::atomic<bool> stopped = false;
+			run_threads(std::max<size_t>(1, thread_count), [&](const size_t) {
+				for (size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+					if (interruptible && is_stop_requested()) {
+						stopped.store(true, std::memory_order_relaxed);
+						return;
+					}
+					SweepTask& task = tasks[chunks[c].first];
+					size_t last = std::min(task.doomed.size(), chunks[c].second + kMarkChunk);
+					for (size_t i = chunks[c].second; i < last; ++i) {
+						task.doomed[i] = is_doomed(get_node(task, i), task.depth);
+					}
+				}
+			});
+			if (stopped.load(std::memory_order_relaxed)) {
+				return false;
+			}
+
+			// the marks move along with the elements, the order matches sweep's
+			auto remove_doomed = [](auto& container, std::vector<char>& doomed, auto get_element, typename NodeMemory::FreeList& freed) {
+				for (size_t i = 0; i < container.size();) {
+					if (doomed[i]) {
+						freed.push(get_element(container[i]));
+						container[i] = std::move(container.back());
+						container.pop_back();
+						doomed[i] = doomed.back();
+						doomed.pop_back();
+					} else {
+						++i;
+					}
+				}
+			};
+			std::atomic<size_t> next_task = 0;
+			run_threads(std::max<size_t>(1, std::min(config.thread_count, tasks.size())), [&](const size_t) {
+				for (size_t t = next_task++; t < tasks.size(); t = next_task++) {
+					SweepTask& task = tasks[t];
+					NodeDepth& depth = depths[task.depth];
+					if (task.phase == NodeDepth::kHeapCount) {
+						remove_doomed(depth.searched, task.doomed, [](Node* node) { return node; }, task.freed);
+					} else {
+						std::vector<NodeValue> heap = depth.get_heap(task.phase).export_container();
+						remove_doomed(heap, task.doomed, [](NodeValue& node_value) { return node_value.node; }, task.freed);
+						depth.get_heap(task.phase).import_container(std::move(heap));
+					}
+				}
+			});
+			for (SweepTask& task : tasks) {
+				memory.release(task.freed);
+			}
+			if (cleanup.survivor != nullptr && cleanup.make_root) {
+				depths[cleanup.depth].make_root();
+			}
+			cleanup.survivor = nullptr;
+			cleanup.depth = cleanup.end;
+			return true;
+		}
+
+		// whether the depths left are worth sweeping on several threads, only between two depths
+		bool is_parallel_cleanup() const {
+			if (config.thread_count < 2 || cleanup.heap_taken || cleanup.phase != 0) {
+				return false;
+			}
+			size_t remaining = 0;
+			for (size_t depth = cleanup.depth; depth < cleanup.end; ++depth) {
+				remaining += depths[depth].size();
+			}
+			return remaining >= kParallelCleanupMinimum;
+		}
+
+		// Resumes the pending cleanup, false when a stop request interrupted it again. Nothing may be allocated while
+		// a cleanup is pending, the sweep tells orphans by their pruned parents. Search entry points run it interruptibly,
+		// queries run it to the end since they need a consistent tree. Rebuilding a depth's heap and the links stays one step.
+		// With thread_count above one large cleanups go through sweep_parallel, whose removal pass is not interrupted.
+		bool run_cleanup(const bool interruptible) {
+			if (!cleanup.active) {
+				return true;
+			}
+			while (!cleanup.table_phase && cleanup.depth < cleanup.end) {
+				if (is_parallel_cleanup()) {
+					if (!sweep_parallel(interruptible)) {
+						return false;
+					}
+					break;
+				}
+				NodeDepth& depth = depths[cleanup.depth];
+				for (; cleanup.phase < NodeDepth::kHeapCount; ++cleanup.phase) {
+					NodeValuePriorityQueue& heap = depth.get_heap(cleanup.phase);
+					if (!cleanup.heap_taken) {
+						cleanup.heap_buffer = heap.export_container();
+						cleanup.heap_taken = true;
+					}
+					if (!sweep(cleanup.heap_buffer, [](NodeValue& node_value) { return node_value.node; }, interruptible)) {
+						return false;
+					}
+					heap.import_container(std::move(cleanup.heap_buffer));
+					cleanup.heap_taken = false;
+				}
+				if (!sweep(depth.searched, [](Node* node) { return node; }, interruptible)) {
+					return false;
+				}
+				cleanup.phase = 0;
+				if (cleanup.survivor != nullptr && cleanup.make_root) {
+					depth.make_root();
+				}
+				cleanup.survivor = nullptr;
+				++cleanup.depth;
+			}
+			cleanup.table_phase = true;
+			auto is_pruned = [this](const uint32_t index) { return memory.get(index)->pruned; };
+			if constexpr (requires { requires TranspositionTable::kConcurrentErase; }) {
+				// erasing is idempotent, so a stopped parallel sweep starts over instead of tracking its ranges
+				size_t slot_count = transposition_table.slot_count();
+				if (config.thread_count > 1 && cleanup.position == 0 && slot_count >= kParallelCleanupMinimum) {
+					constexpr size_t kEraseChunk = 16 * kCleanupChunk;
+					std::atomic<size_t> next_slot = 0;
+					std::atomic<bool> stopped = false;
+					run_threads(config.thread_count, [&](const size_t) {
+						for (size_t first = next_slot.fetch_add(kEraseChunk); first < slot_count; first = next_slot.fetch_add(kEraseChunk)) {
+							if (interruptible && is_stop_requested()) {
+								stopped.store(true, std::memory_order_relaxed);
+								return;
+							}
+							transposition_table.erase_if(is_pruned, first, std::min(slot_count, first + kEraseChunk));
+						}
+					});
+					if (stopped.load(std::memory_order_relaxed)) {
+						return false;
+					}
+					cleanup.position = slot_count;
+				}
+			}
+			while (cleanup.position < transposition_table.slot_count()) {
+				if (interruptible && is_stop_requested()) {
+					return false;
+				}
+				size_t last = std::min(transposition_table.slot_count(), cleanup.position + kCleanupChunk);
+				transposition_table.erase_if(is_pruned, cleanup.position, last);
+				cleanup.position = last;
+			}
+			cleanup.active = false;
+			cleanup.table_phase = false;
+			cleanup.position = 0;
+			transposition_table.reserve(config.node_limit);
+			if (solution != nullptr && (solution->pruned || solution->parent == nullptr)) {
+				solution = nullptr;
+			}
+			if (is_tracking_links()) {
+				rebuild_links();
+			}
+			if (config.mode == SearchMode::best_first) {
+				rebuild_open_list();
+			}
+			return true;
+		}
+
+		bool prune() {
+			if (config.prune_depth_limit == 0) {
+				return false;
+			}
+
+			size_t first_active_depth_index = get_first_active_depth_index();
+			size_t last_active_depth_index = get_last_active_depth_index();
+
+			if (first_active_depth_index > config.prune_depth_limit) {
+				return false;
+			}
+			if (first_active_depth_index == last_active_depth_index) {
+				return false;
+			}
+			if (last_active_depth_index == std::numeric_limits<size_t>::max()) {
+				throw std::runtime_error("node_limit is too low"); // maybe can remove if never triggers
+			}
+
+			const Node* best_node = nullptr;
+			if (config.backup != ValueBackup::none && config.mode != SearchMode::mcts) {
+				best_node = get_backed_up_node_at(first_active_depth_index);
+			}
+			if (best_node == nullptr) {
+				size_t first_and_last_depth_index_diff = last_active_depth_index - first_active_depth_index;
+				best_node = get_best_node();
+				if (best_node == nullptr) {
+					return false;
+				}
+				best_node = best_node->get_parent_at(first_and_last_depth_index_diff);
+			}
+
+			start_cleanup(first_active_depth_index, last_active_depth_index + 1, best_node, false);
+			return run_cleanup(true);
+		}
+
 		void reset_metrics() {
+			tasks_since_decision_check = 0;
+			decision_settled = false;
+			tasks_since_snapshot = 0;
+			total_numa_local = 0;
+			total_numa_remote = 0;
 			total_searched = 0;
 			total_collision = 0;
+			total_shared_hit = 0;
+			total_bound_skip = 0;
 		}
 
 	    public:
@@ -325,12 +1725,29 @@ namespace noir::ctt {
 			return config;
 		}
 
+		// once token is stopped get_task, expand_beam_layer and expand_batch return nothing within about kCleanupChunk
+		// nodes of work, also in the middle of a prune or re-root (bar the removal pass of sweep_parallel). That cleanup
+		// resumes with the next search call after a token that is not stopped is set, queries such as get_result finish
+		// it regardless of the token.
+		void set_stop_token(std::stop_token token) {
+			stop_token = std::move(token);
+		}
+
+		bool is_cleanup_pending() const {
+			return cleanup.active;
+		}
+
+		// evaluations done by try_child are published to and reused from table, nullptr detaches
+		void set_shared_table(SharedTranspositionTable* table) {
+			shared_table = table;
+		}
+
 		bool verify_state() {
 			if (node_cursor.allocated_node == nullptr || node_cursor.allocated_node->pruned) {
 				return false;
 			}
 			uint64_t hash = state_hash(node_cursor.allocated_node->state);
-			if (!transposition_table.try_emplace(hash, node_cursor.allocated_node).second) {
+			if (!transposition_table.try_emplace(hash, node_cursor.allocated_node->index).second) {
 				++total_collision;
 				memory.deallocate(node_cursor.allocated_node);
 				return false;
@@ -338,8 +1755,17 @@ namespace noir::ctt {
 			return true;
 		}
 
+		// an interrupted cleanup from before is finished first, the new one stops early on a stop request and resumes
+		// with the next search call
 		void prepare_tree(const State& current_state) {
+			flush_pending_child();
+			// the task may be freed by the cleanup, try_child must not add children under it
+			node_cursor.cursor = nullptr;
+			node_cursor.chain_candidate = false;
+			run_cleanup(false);
 			reset_metrics();
+			// the depth horizon moves with the root, so mcts resolves the kept subtree again
+			std::fill(statistics.resolved.begin(), statistics.resolved.end(), 0);
 			if (depths.size() <= config.depth) {
 				reset(current_state);
 				return;
@@ -350,25 +1776,33 @@ namespace noir::ctt {
 				reset(current_state);
 				return;
 			}
-			const Node* best_leaf = get_best_node();
-			if (best_leaf == nullptr) {
+			const Node* best_parent = get_best_root_child();
+			if (best_parent == nullptr) {
 				reset(current_state);
 				return;
 			}
-			const Node* best_parent = best_leaf->get_first_parent();
 			if (!state_equal(best_parent->state, current_state)) {
-				reset(current_state);
-				return;
-			}
-			memory.deallocate(root);
-			auto front_depth = std::move(depths.front());
-			for (size_t i = 0; i < depths.size() - 1; ++i) {
-				depths[i] = std::move(depths[i + 1]);
+				const std::vector<State>* chain = best_parent->chain_length == 0 ? nullptr : &chains[best_parent->index];
+				size_t count = 0;
+				while (chain != nullptr && count < best_parent->chain_length && !state_equal((*chain)[count], current_state)) {
+					++count;
+				}
+				if (chain == nullptr || count == best_parent->chain_length) {
+					reset(current_state);
+					return;
+				}
+				enter_chain(root, memory.get(best_parent->index), count + 1, current_state);
+			} else {
+				memory.deallocate(root);
+				auto front_depth = std::move(depths.front());
+				for (size_t i = 0; i < depths.size() - 1; ++i) {
+					depths[i] = std::move(depths[i + 1]);
+				}
+				memory.get(best_parent->index)->chain_length = 0;
+				depths.back().clear();
+				start_cleanup(0, depths.size() - 1, best_parent, true);
 			}
-			depths.front().filter(best_parent, memory);
-			depths.front().make_root();
-			depths.back().clear();
-			cleanup(1, depths.size() - 1);
+			run_cleanup(true);
 		}
 
 		void increment_depth_counter() {
@@ -379,6 +1813,36 @@ namespace noir::ctt {
 		}
 
 		State* get_task() {
+			flush_pending_child();
+			node_cursor.chain_candidate = false;
+			if (is_stop_requested() || !run_cleanup(true)) {
+				return nullptr;
+			}
+			if (config.snapshot_interval != 0 && ++tasks_since_snapshot >= config.snapshot_interval) {
+				tasks_since_snapshot = 0;
+				publish_snapshot();
+			}
+			if (config.early_stop) {
+				if (!decision_settled && ++tasks_since_decision_check >= config.early_stop_interval) {
+					tasks_since_decision_check = 0;
+					decision_settled = is_decision_settled();
+				}
+				if (decision_settled) {
+					return nullptr;
+				}
+			}
+			if (config.mode == SearchMode::mcts) {
+				return get_mcts_task();
+			}
+			if (config.mode == SearchMode::beam) {
+				return nullptr; // layers are expanded through expand_beam_layer
+			}
+			if (config.mode == SearchMode::best_first) {
+				return get_best_first_task();
+			}
+			if (solution != nullptr) {
+				return nullptr;
+			}
 			if (memory.is_limit_reached(config.node_limit)) {
 				if (!prune()) {
 					return nullptr;
@@ -386,7 +1850,15 @@ namespace noir::ctt {
 			}
 			size_t check_count = 0;
 			size_t last_depth_counter = node_cursor.depth;
-			while (check_count != depths.size() && depths[node_cursor.depth].unsearched.empty()) {
+			while (check_count != depths.size()) {
+				NodeDepth& depth = depths[node_cursor.depth];
+				// terminal nodes are never handed out but stay leaves get_best_node can pick
+				while (!depth.unsearched.empty() && depth.unsearched.top().node->terminal) {
+					depth.hold_terminal();
+				}
+				if (!depth.unsearched.empty()) {
+					break;
+				}
 				++check_count;
 				increment_depth_counter();
 			}
@@ -394,30 +1866,822 @@ namespace noir::ctt {
 				node_cursor.depth = last_depth_counter;
 				return nullptr;
 			}
+			node_cursor.value = depths[node_cursor.depth].unsearched.top().value;
 			node_cursor.cursor = depths[node_cursor.depth].get_unsearched_node();
+			node_cursor.chain_candidate = is_compressing_chains() && node_cursor.cursor->parent != nullptr && node_cursor.cursor->move_cursor == 0;
 			return &node_cursor.cursor->state;
 		}
 
+		// partial expansion: the caller generates children of the current task from get_move_cursor() on
+		size_t get_move_cursor() const {
+			return node_cursor.cursor == nullptr ? 0 : node_cursor.cursor->move_cursor;
+		}
+
+		// re-queues the current task instead of finishing it, next_value estimates its best child not generated yet
+		// so the remaining children are only produced once that value reaches the front of the queue
+		void defer_task(const size_t next_cursor, const double next_value) {
+			Node* node = node_cursor.cursor;
+			if (node == nullptr || node->pruned) {
+				return;
+			}
+			// the children not generated yet rule out a forced move
+			if (pending_child.active) {
+				commit_pending_child();
+			}
+			node_cursor.chain_candidate = false;
+			node->move_cursor = static_cast<uint32_t>(next_cursor);
+			node->expanded = false;
+			switch (config.mode) {
+				case SearchMode::layered: {
+					NodeDepth& depth = depths[node_cursor.depth];
+					assert(!depth.searched.empty() && depth.searched.back() == node);
+					depth.searched.pop_back();
+					depth.push(node, next_value);
+					break;
+				}
+				case SearchMode::best_first:
+					open_list.push({node, get_open_value(next_value, node_cursor.depth), node_cursor.depth});
+					break;
+				case SearchMode::mcts:
+					// selection stops at unexpanded nodes, so the node is widened when UCT reaches it again
+					break;
+				case SearchMode::beam:
+					break;
+			}
+			node_cursor.cursor = nullptr;
+		}
+
 		State* get_new_state() {
 			node_cursor.allocated_node = memory.allocate(node_cursor.cursor);
 			return &node_cursor.allocated_node->state;
 		}
 
-		void report_result(const double value) {
+		void report_result(const double value, const bool terminal = false) {
 			++total_searched;
 			assert(node_cursor.depth + 1 != depths.size());
-			depths[node_cursor.depth + 1].push(node_cursor.allocated_node, value);
+			add_child(node_cursor.allocated_node, node_cursor.depth + 1, value, terminal);
 		}
 
-		const State* get_result() const {
-			size_t last_depth_index = get_last_active_depth_index();
-			if (depths[last_depth_index].unsearched.empty()) {
+		// Beam mode: expands every unsearched node of the deepest open layer through expand_fn(const State&, ChildSink&),
+		// split over config.thread_count threads. Each thread keeps its best beam_width candidates, the merged best
+		// beam_width become the next layer and everything else is dropped without touching the node pool.
+		// Returns the number of committed children, 0 once the last depth is reached or the decision is settled.
+		template <typename ExpandFunc>
+		size_t expand_beam_layer(ExpandFunc&& expand_fn) {
+			if (is_stop_requested() || !run_cleanup(true)) {
+				return 0;
+			}
+			if (config.early_stop) {
+				if (!decision_settled) {
+					decision_settled = is_decision_settled();
+				}
+				if (decision_settled) {
+					return 0;
+				}
+			}
+			size_t layer = get_last_active_depth_index();
+			if (solution != nullptr || layer == std::numeric_limits<size_t>::max() || layer + 1 >= depths.size() || depths[layer].unsearched.empty()) {
+				return 0;
+			}
+			std::vector<NodeValue> layer_values;
+			std::vector<Node*> parents;
+			layer_values.reserve(depths[layer].unsearched.size());
+			parents.reserve(depths[layer].unsearched.size());
+			while (!depths[layer].unsearched.empty()) {
+				layer_values.emplace_back(depths[layer].unsearched.top());
+				Node* parent = depths[layer].get_unsearched_node();
+				if (!parent->terminal) {
+					parents.emplace_back(parent);
+				}
+			}
+			if (parents.empty()) {
+				return 0;
+			}
+			size_t thread_count = std::max<size_t>(1, std::min(config.thread_count, parents.size()));
+			std::vector<ChildSink> sinks;
+			sinks.reserve(thread_count);
+			for (size_t i = 0; i < thread_count; ++i) {
+				sinks.emplace_back(ChildSink(*this));
+			}
+			WorkerArenas arenas(memory, thread_count, config.numa_aware);
+			std::vector<size_t> owners = route_tasks(parents.size(), thread_count, [&parents](const size_t i) { return parents[i]; });
+			auto expand_share = [&](const size_t thread_index) {
+				ScopedThreadPin pin(get_worker_cpu(thread_index));
+				ChildSink& sink = sinks[thread_index];
+				bind_worker(sink, thread_index);
+				for (size_t i = 0; i < parents.size() && !is_stop_requested(); ++i) {
+					if (owners[i] != thread_index) {
+						continue;
+					}
+					sink.parent = parents[i];
+					sink.numa_sampler.sample(parents[i]);
+					expand_fn(static_cast<const State&>(parents[i]->state), sink);
+				}
+				sink.select(config.beam_width);
+				arenas.reserve(thread_index, sink.candidates.size(), get_worker_home(thread_index));
+			};
+			run_threads(thread_count, expand_share);
+			if (is_stop_requested()) {
+				// the layer goes back to unsearched untouched, the next call expands it again
+				depths[layer].searched.resize(depths[layer].searched.size() - layer_values.size());
+				for (const NodeValue& node_value : layer_values) {
+					node_value.node->expanded = false;
+				}
+				// popped best first, so already in heap order
+				depths[layer].unsearched.import_heap(std::move(layer_values));
+				return 0;
+			}
+
+			std::vector<ChildCandidate> candidates;
+			for (ChildSink& sink : sinks) {
+				total_searched += sink.searched_count;
+				total_collision += sink.collision_count;
+				total_shared_hit += sink.shared_hit_count;
+				total_bound_skip += sink.bound_skip_count;
+				add_worker_counts(sink);
+				std::move(sink.candidates.begin(), sink.candidates.end(), std::back_inserter(candidates));
+			}
+			std::sort(candidates.begin(), candidates.end(), is_better_candidate);
+			size_t committed = 0;
+			for (ChildCandidate& candidate : candidates) {
+				if (committed == config.beam_width) {
+					break;
+				}
+				auto [slot, inserted] = transposition_table.try_emplace(candidate.hash, TranspositionTable::kNone);
+				if (!inserted) {
+					++total_collision;
+					continue;
+				}
+				commit_arena = arenas.get(candidate.worker);
+				Node* node = allocate_node(candidate.parent);
+				node->state = std::move(candidate.state);
+				TranspositionTable::assign(slot, node->index);
+				add_child(node, layer + 1, candidate.evaluation.value, candidate.evaluation.terminal);
+				++committed;
+			}
+			commit_arena = nullptr;
+			if (config.snapshot_interval != 0) {
+				publish_snapshot();
+			}
+			return committed;
+		}
+
+		// Deterministic parallel layered search, one epoch per call: takes up to batch_size tasks the way get_task
+		// would, expands them through expand_fn(const State&, ChildSink&) on thread_count threads against the tree as it
+		// stood when the epoch began, then commits the children on the calling thread in task order and generation
+		// order. The tree and get_result() depend on batch_size but not on thread_count, as long as evaluate_fn is
+		// deterministic and no shared table is attached. The price: tasks of one epoch do not see each other's
+		// children, commits are serial and threads wait for the slowest share, so an epoch does less useful work
+		// per evaluation than the sequential get_task loop and scales below thread_count.
+		// node_limit caps an epoch at the tasks whose children, at the last epoch's rate, still fit; should the tree
+		// reach the limit anyway, the tasks not committed yet are queued again for the epoch after the prune.
+		// A stop request ends the epoch without committing: its tasks are queued again and the call returns 0.
+		// Returns the number of tasks committed, 0 once get_task has nothing left.
+		template <typename ExpandFunc>
+		size_t expand_batch(ExpandFunc&& expand_fn) {
+			struct BatchTask {
+				Node* node;
+				size_t depth;
+				double value;
+				bool chain_candidate;
+			};
+			if (config.mode != SearchMode::layered) {
+				return 0;
+			}
+			std::vector<BatchTask> tasks;
+			tasks.reserve(config.batch_size);
+			size_t task_limit = config.batch_size;
+			for (size_t i = 0; i < task_limit; ++i) {
+				// a prune would free tasks taken before it, so it waits for the next epoch
+				if (!tasks.empty() && memory.is_limit_reached(config.node_limit)) {
+					break;
+				}
+				if (get_task() == nullptr) {
+					break;
+				}
+				tasks.push_back({node_cursor.cursor, node_cursor.depth, node_cursor.value, node_cursor.chain_candidate});
+				increment_depth_counter();
+				// the first get_task may have pruned, the tree does not change after it
+				if (tasks.size() == 1 && batch_children_per_task > 0) {
+					size_t headroom = config.node_limit - std::min(config.node_limit, memory.size());
+					task_limit = std::clamp<size_t>(static_cast<size_t>(headroom / batch_children_per_task), 1, config.batch_size);
+				}
+			}
+			if (tasks.empty()) {
+				return 0;
+			}
+			// arenas count as used once reserved, so the commits are counted against the size before them
+			const size_t tree_size = memory.size();
+			// puts tasks from first on back into their unsearched heaps, in reverse so each one is the last of its
+			// depth's searched nodes
+			auto requeue_tasks = [&](const size_t first) {
+				for (size_t i = tasks.size(); i-- > first;) {
+					NodeDepth& depth = depths[tasks[i].depth];
+					auto it = std::find(depth.searched.rbegin(), depth.searched.rend(), tasks[i].node);
+					depth.searched.erase(std::next(it).base());
+					tasks[i].node->expanded = false;
+					depth.push(tasks[i].node, tasks[i].value);
+				}
+			};
+
+			size_t thread_count = std::max<size_t>(1, std::min(config.thread_count, tasks.size()));
+			std::vector<ChildSink> sinks;
+			sinks.reserve(thread_count);
+			for (size_t i = 0; i < thread_count; ++i) {
+				sinks.emplace_back(ChildSink(*this));
+				sinks.back().beam = false;
+			}
+			WorkerArenas arenas(memory, thread_count, config.numa_aware);
+			std::vector<size_t> owners = route_tasks(tasks.size(), thread_count, [&tasks](const size_t i) { return tasks[i].node; });
+			run_threads(thread_count, [&](const size_t thread_index) {
+				ScopedThreadPin pin(get_worker_cpu(thread_index));
+				ChildSink& sink = sinks[thread_index];
+				bind_worker(sink, thread_index);
+				for (size_t i = 0; i < tasks.size() && !is_stop_requested(); ++i) {
+					if (owners[i] != thread_index) {
+						continue;
+					}
+					sink.parent = tasks[i].node;
+					sink.numa_sampler.sample(tasks[i].node);
+					expand_fn(static_cast<const State&>(tasks[i].node->state), sink);
+				}
+				arenas.reserve(thread_index, sink.candidates.size(), get_worker_home(thread_index));
+			});
+			if (is_stop_requested()) {
+				requeue_tasks(0);
+				node_cursor.cursor = nullptr;
+				node_cursor.chain_candidate = false;
+				return 0;
+			}
+
+			std::unordered_set<const Node*> bound_skipped;
+			for (ChildSink& sink : sinks) {
+				total_collision += sink.collision_count;
+				total_shared_hit += sink.shared_hit_count;
+				total_bound_skip += sink.bound_skip_count;
+				bound_skipped.insert(sink.bound_skipped_parents.begin(), sink.bound_skipped_parents.end());
+				add_worker_counts(sink);
+			}
+			// every sink holds its tasks' children grouped by task, in task order
+			const size_t last_depth_counter = node_cursor.depth;
+			std::vector<size_t> sink_cursors(thread_count);
+			size_t committed = 0;
+			size_t committed_children = 0;
+			for (; committed < tasks.size(); ++committed) {
+				const size_t i = committed;
+				if (i != 0 && tree_size + committed_children >= config.node_limit) {
+					requeue_tasks(i);
+					break;
+				}
+				ChildSink& sink = sinks[owners[i]];
+				size_t& cursor = sink_cursors[owners[i]];
+				node_cursor.cursor = tasks[i].node;
+				node_cursor.depth = tasks[i].depth;
+				node_cursor.chain_candidate = tasks[i].chain_candidate && !bound_skipped.contains(tasks[i].node);
+				commit_arena = arenas.get(owners[i]);
+				for (; cursor < sink.candidates.size() && sink.candidates[cursor].parent == tasks[i].node; ++cursor) {
+					if (solution != nullptr) {
+						continue;
+					}
+					ChildCandidate& candidate = sink.candidates[cursor];
+					auto [slot, inserted] = transposition_table.try_emplace(candidate.hash, TranspositionTable::kNone);
+					if (!inserted) {
+						++total_collision;
+						continue;
+					}
+					commit_child(slot, candidate.hash, candidate.state, candidate.evaluation);
+					++committed_children;
+				}
+				flush_pending_child();
+			}
+			commit_arena = nullptr;
+			node_cursor.cursor = nullptr;
+			node_cursor.chain_candidate = false;
+			node_cursor.depth = last_depth_counter;
+			batch_children_per_task = static_cast<double>(committed_children) / static_cast<double>(committed);
+			return committed;
+		}
+
+		// Pipelined layered or best-first search over up to task_limit tasks. The calling thread takes the tasks and
+		// commits the children, so it is the only one changing the manager. One thread runs
+		// generate_fn(const State&, GenerateSink&) over the tasks and thread_count threads hash the children and run
+		// evaluate_fn(State&) on them, which must be safe to call concurrently. Bounded lock-free rings of
+		// pipeline_capacity slots connect the stages: SPSC from the caller to the generator and from the generator to
+		// every evaluator, MPSC from the evaluators back to the caller. Children are deduplicated when they are committed,
+		// so duplicates are evaluated as well, commits arrive in no fixed order and chains are not compressed.
+		// Returns the number of tasks taken, 0 once get_task has nothing left.
+		template <typename GenerateFunc, typename EvaluateFunc>
+		size_t expand_pipeline(const size_t task_limit, GenerateFunc&& generate_fn, EvaluateFunc&& evaluate_fn) {
+			if (config.mode != SearchMode::layered && config.mode != SearchMode::best_first) {
+				return 0;
+			}
+			const size_t evaluator_count = std::max<size_t>(1, config.thread_count);
+			SpscRing<PipelineTask> task_ring(config.pipeline_capacity);
+			std::deque<SpscRing<PipelineChild>> evaluator_rings;
+			for (size_t i = 0; i < evaluator_count; ++i) {
+				evaluator_rings.emplace_back(config.pipeline_capacity);
+			}
+			MpscRing<PipelineChild> result_ring(config.pipeline_capacity);
+			std::atomic<size_t> generated_tasks = 0;
+			std::atomic<size_t> generated_children = 0;
+			std::atomic<bool> finished = false;
+			std::vector<size_t> shared_hit_counts(evaluator_count);
+			NumaAccessSampler numa_sampler;
+
+			// the generator reads the task nodes, so it is the one that samples them
+			std::thread generator([&]() {
+				ScopedThreadPin pin(get_worker_cpu(0));
+				if (config.numa_aware) {
+					numa_sampler.node = NumaTopology::get().get_current_node();
+				}
+				GenerateSink sink(evaluator_rings);
+				PipelineTask task;
+				while (true) {
+					if (task_ring.try_pop(task)) {
+						numa_sampler.sample(task.node);
+						sink.parent = task.node;
+						sink.parent_depth = task.depth;
+						generate_fn(static_cast<const State&>(task.node->state), sink);
+						// the children count is published before the task count, see is_idle
+						generated_children.store(sink.generated_count, std::memory_order_release);
+						generated_tasks.fetch_add(1, std::memory_order_release);
+					} else if (finished.load(std::memory_order_acquire)) {
+						break;
+					} else {
+						std::this_thread::yield();
+					}
+				}
+			});
+			std::vector<std::thread> evaluators;
+			evaluators.reserve(evaluator_count);
+			for (size_t i = 0; i < evaluator_count; ++i) {
+				evaluators.emplace_back([&, i]() {
+					ScopedThreadPin pin(get_worker_cpu(i + 1));
+					StateHasher hasher(state_hash);
+					PipelineChild child;
+					while (true) {
+						if (evaluator_rings[i].try_pop(child)) {
+							child.hash = hasher(child.state);
+							child.evaluation = evaluate_state(shared_table, child.hash, child.state, evaluate_fn, shared_hit_counts[i]);
+							while (!result_ring.try_push(std::move(child))) {
+								std::this_thread::yield();
+							}
+						} else if (finished.load(std::memory_order_acquire)) {
+							break;
+						} else {
+							std::this_thread::yield();
+						}
+					}
+				});
+			}
+
+			size_t taken = 0;
+			size_t sent = 0;
+			size_t committed = 0;
+			size_t depth_counter = node_cursor.depth;
+			bool has_task = false;
+			bool may_have_task = true; // false after get_task came back empty, until a commit adds nodes
+			PipelineTask task;
+			PipelineChild child;
+			auto is_idle = [&]() {
+				return generated_tasks.load(std::memory_order_acquire) == sent && committed == generated_children.load(std::memory_order_acquire);
+			};
+			while (true) {
+				if (!has_task && may_have_task && taken < task_limit) {
+					bool idle = is_idle();
+					// a prune would free tasks in flight, so it waits until the pipeline is empty
+					if (idle || !memory.is_limit_reached(config.node_limit)) {
+						node_cursor.depth = depth_counter;
+						if (get_task() != nullptr) {
+							task = {node_cursor.cursor, node_cursor.depth};
+							increment_depth_counter();
+							has_task = true;
+							++taken;
+						} else if (idle) {
+							depth_counter = node_cursor.depth;
+							break;
+						} else {
+							may_have_task = false;
+						}
+						depth_counter = node_cursor.depth;
+					}
+				}
+				if (has_task && task_ring.try_push(task)) {
+					has_task = false;
+					++sent;
+				}
+				bool progressed = false;
+				while (result_ring.try_pop(child)) {
+					++committed;
+					progressed = true;
+					if (solution != nullptr) {
+						continue;
+					}
+					node_cursor.cursor = child.parent;
+					node_cursor.depth = child.depth;
+					node_cursor.chain_candidate = false;
+					auto [slot, inserted] = transposition_table.try_emplace(child.hash, TranspositionTable::kNone);
+					if (!inserted) {
+						++total_collision;
+						continue;
+					}
+					commit_child(slot, child.hash, child.state, child.evaluation);
+				}
+				if (progressed) {
+					may_have_task = true;
+				}
+				if (!has_task && (taken == task_limit || !may_have_task) && is_idle()) {
+					if (taken == task_limit) {
+						break;
+					}
+					may_have_task = true; // the last tasks may have added nodes, get_task decides
+				} else if (!progressed) {
+					std::this_thread::yield();
+				}
+			}
+			finished.store(true, std::memory_order_release);
+			generator.join();
+			for (std::thread& evaluator : evaluators) {
+				evaluator.join();
+			}
+			for (size_t count : shared_hit_counts) {
+				total_shared_hit += count;
+			}
+			total_numa_local += numa_sampler.local_count;
+			total_numa_remote += numa_sampler.remote_count;
+			node_cursor.cursor = nullptr;
+			node_cursor.chain_candidate = false;
+			node_cursor.depth = depth_counter;
+			return taken;
+		}
+
+		// applies move to a scratch copy of the current task and only commits it to the node pool if it is not a duplicate
+		template <typename Move, typename ApplyFunc, typename EvaluateFunc>
+		bool try_child(const Move& move, ApplyFunc&& apply_fn, EvaluateFunc&& evaluate_fn) {
+			if (node_cursor.cursor == nullptr || node_cursor.cursor->pruned || solution != nullptr) {
+				return false;
+			}
+			scratch_state = node_cursor.cursor->state;
+			apply_fn(scratch_state, move);
+			return add_scratch_child(evaluate_fn);
+		}
+
+		// two-stage try_child: bound_fn(const State&) is an optimistic estimate of the value evaluate_fn would give,
+		// children whose bound is below config.bound_cutoff are dropped before hashing and the full evaluation
+		template <typename Move, typename ApplyFunc, typename BoundFunc, typename EvaluateFunc>
+		bool try_child(const Move& move, ApplyFunc&& apply_fn, BoundFunc&& bound_fn, EvaluateFunc&& evaluate_fn) {
+			if (node_cursor.cursor == nullptr || node_cursor.cursor->pruned || solution != nullptr) {
+				return false;
+			}
+			scratch_state = node_cursor.cursor->state;
+			apply_fn(scratch_state, move);
+			if (is_below_cutoff(static_cast<double>(bound_fn(static_cast<const State&>(scratch_state))))) {
+				++total_bound_skip;
+				// the dropped child is still a legal move, so the task is not a forced one
+				if (pending_child.active) {
+					commit_pending_child();
+				}
+				node_cursor.chain_candidate = false;
+				return false;
+			}
+			return add_scratch_child(evaluate_fn);
+		}
+
+		const State* get_result() {
+			flush_pending_child();
+			run_cleanup(false);
+			if (solution != nullptr || config.mode == SearchMode::mcts || config.backup != ValueBackup::none) {
+				const Node* best = get_best_root_child();
+				return best == nullptr ? nullptr : &get_edge_state(best);
+			}
+			const Node* best_leaf = get_best_node();
+			if (best_leaf == nullptr) {
 				return nullptr;
 			}
-			return &depths[last_depth_index].unsearched.top().node->get_first_parent()->state;
+			// only the root is open before the first expansion
+			const Node* first_parent = best_leaf->get_first_parent();
+			return first_parent == nullptr ? nullptr : &get_edge_state(first_parent);
 		}
 
-		bool are_depths_populated() const {
+		double get_result_value() {
+			flush_pending_child();
+			run_cleanup(false);
+			if (solution != nullptr) {
+				return solution_value;
+			}
+			if (config.mode == SearchMode::mcts) {
+				const Node* best = get_most_visited_root_child();
+				return best == nullptr ? std::numeric_limits<double>::lowest() : statistics.get_mean(best->index);
+			}
+			if (config.backup != ValueBackup::none) {
+				const Node* best = get_best_root_child();
+				return best == nullptr ? std::numeric_limits<double>::lowest() : statistics.backed_value[best->index];
+			}
+			size_t last_depth_index = get_last_active_depth_index();
+			const NodeValue* best_leaf = last_depth_index == std::numeric_limits<size_t>::max() ? nullptr : depths[last_depth_index].get_best_leaf();
+			return best_leaf == nullptr ? std::numeric_limits<double>::lowest() : best_leaf->value;
+		}
+
+		// search thread only: stores the current result and counters for read_snapshot, costs one get_result()
+		void publish_snapshot() {
+			SearchSnapshot current = {};
+			const State* result = get_result();
+			if (result != nullptr) {
+				current.result = *result;
+				current.has_result = true;
+			}
+			current.solved = solution != nullptr;
+			current.settled = decision_settled;
+			current.result_value = get_result_value();
+			current.node_count = memory.size();
+			current.searched = total_searched;
+			current.collision = total_collision;
+			current.shared_hit = total_shared_hit;
+			current.bound_skip = total_bound_skip;
+			snapshot.store(current);
+		}
+
+		// any thread, lock-free: the last published snapshot, never torn
+		SearchSnapshot read_snapshot() const {
+			return snapshot.load();
+		}
+
+		// number of snapshots published so far, cheap to poll for a new one
+		uint64_t get_snapshot_version() const {
+			return snapshot.get_version();
+		}
+
+		// a child held back for chain compression is committed to the tree first
+		void save(const std::string& path) {
+			static_assert(std::is_trivially_copyable_v<State>);
+			flush_pending_child();
+			run_cleanup(false);
+			SnapshotHeader header = {};
+			header.magic = kSnapshotMagic;
+			header.state_size = sizeof(State);
+			header.depth_count = depths.size();
+			header.cursor_depth = node_cursor.depth;
+			header.total_searched = total_searched;
+			header.total_collision = total_collision;
+
+			std::vector<SnapshotDepth> snapshot_depths;
+			std::vector<SnapshotNode> snapshot_nodes;
+			std::vector<const Node*> nodes;
+			std::unordered_map<const Node*, uint64_t> node_index;
+			snapshot_depths.reserve(depths.size());
+			node_index.reserve(memory.size());
+			auto add_node = [&](const Node* node, double value) {
+				auto parent = node->parent == nullptr ? node_index.end() : node_index.find(node->parent);
+				node_index.emplace(node, nodes.size());
+				nodes.emplace_back(node);
+				snapshot_nodes.push_back({parent == node_index.end() ? kNoParent : parent->second, value, node->chain_length, node->move_cursor, node->terminal});
+				header.chain_state_count += node->chain_length;
+			};
+			for (NodeDepth& depth : depths) {
+				for (size_t heap = 0; heap < NodeDepth::kHeapCount; ++heap) {
+					for (const NodeValue& node_value : depth.get_heap(heap).get_container()) {
+						add_node(node_value.node, node_value.value);
+					}
+				}
+				// a searched node's own value is only kept where the backup needs it
+				for (const Node* node : depth.searched) {
+					add_node(node, is_tracking_links() ? statistics.static_value[node->index] : 0);
+				}
+				snapshot_depths.push_back({depth.unsearched.size(), depth.terminals.size(), depth.searched.size()});
+			}
+			header.solution = kNoParent;
+			if (solution != nullptr) {
+				header.solution = node_index.at(solution);
+				header.solution_value = solution_value;
+			}
+			// the table is rebuilt from the states it was filled with, a dedup policy need not keep full hashes
+			std::vector<SnapshotEntry> snapshot_entries;
+			snapshot_entries.reserve(nodes.size() + header.chain_state_count);
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				for (uint32_t j = 0; j < nodes[i]->chain_length; ++j) {
+					snapshot_entries.push_back({state_hash(chains[nodes[i]->index][j]), i});
+				}
+				snapshot_entries.push_back({state_hash(nodes[i]->state), i});
+			}
+			header.node_count = nodes.size();
+			header.table_count = snapshot_entries.size();
+
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				throw std::runtime_error("cannot open " + path);
+			}
+			auto write = [&file](const void* data, size_t size) {
+				file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			};
+			write(&header, sizeof(header));
+			write(snapshot_depths.data(), snapshot_depths.size() * sizeof(SnapshotDepth));
+			write(snapshot_nodes.data(), snapshot_nodes.size() * sizeof(SnapshotNode));
+			write(snapshot_entries.data(), snapshot_entries.size() * sizeof(SnapshotEntry));
+			size_t written = sizeof(header) + snapshot_depths.size() * sizeof(SnapshotDepth) + snapshot_nodes.size() * sizeof(SnapshotNode) + snapshot_entries.size() * sizeof(SnapshotEntry);
+			const char padding[alignof(State) > alignof(uint64_t) ? alignof(State) : alignof(uint64_t)] = {};
+			write(padding, get_snapshot_states_offset(header) - written);
+			for (const Node* node : nodes) {
+				if (node->chain_length != 0) {
+					write(chains[node->index].data(), node->chain_length * sizeof(State));
+				}
+				write(&node->state, sizeof(State));
+			}
+			if (!file) {
+				throw std::runtime_error("cannot write " + path);
+			}
+		}
+
+		// replaces the whole tree; states are copied straight out of the mapping into the node pool
+		void load(const std::string& path) {
+			static_assert(std::is_trivially_copyable_v<State>);
+			MappedFile file(path);
+			const SnapshotHeader& header = *file.at<SnapshotHeader>(0);
+			if (header.magic != kSnapshotMagic || header.state_size != sizeof(State) || header.depth_count == 0) {
+				throw std::runtime_error("incompatible snapshot " + path);
+			}
+			size_t offset = sizeof(SnapshotHeader);
+			const SnapshotDepth* snapshot_depths = file.at<SnapshotDepth>(offset, header.depth_count);
+			offset += header.depth_count * sizeof(SnapshotDepth);
+			const SnapshotNode* snapshot_nodes = file.at<SnapshotNode>(offset, header.node_count);
+			offset += header.node_count * sizeof(SnapshotNode);
+			const SnapshotEntry* snapshot_entries = file.at<SnapshotEntry>(offset, header.table_count);
+			const std::byte* states = reinterpret_cast<const std::byte*>(file.at<State>(get_snapshot_states_offset(header), header.node_count + header.chain_state_count));
+			size_t state_cursor = 0;
+
+			memory.reset();
+			transposition_table.clear();
+			cleanup.active = false;
+			cleanup.heap_buffer.clear();
+			for (NodeDepth& depth : depths) {
+				depth.clear();
+			}
+			depths.resize(header.depth_count);
+			config.depth = header.depth_count - 1;
+
+			std::vector<Node*> nodes;
+			nodes.reserve(header.node_count);
+			auto load_node = [&]() {
+				const SnapshotNode& snapshot_node = snapshot_nodes[nodes.size()];
+				if (snapshot_node.parent != kNoParent && snapshot_node.parent >= nodes.size()) {
+					throw std::runtime_error("corrupt snapshot " + path);
+				}
+				Node* node = memory.allocate(snapshot_node.parent == kNoParent ? nullptr : nodes[snapshot_node.parent]);
+				if (node->parent != nullptr) {
+					node->parent->expanded = true;
+				}
+				if (snapshot_node.chain_length > header.node_count + header.chain_state_count - state_cursor - 1) {
+					throw std::runtime_error("corrupt snapshot " + path);
+				}
+				if (snapshot_node.chain_length != 0) {
+					chains.resize(memory.capacity());
+					std::vector<State>& chain = chains[node->index];
+					chain.resize(snapshot_node.chain_length);
+					std::memcpy(static_cast<void*>(chain.data()), states + state_cursor * sizeof(State), snapshot_node.chain_length * sizeof(State));
+					node->chain_length = static_cast<uint32_t>(snapshot_node.chain_length);
+					state_cursor += snapshot_node.chain_length;
+				}
+				std::memcpy(static_cast<void*>(&node->state), states + state_cursor++ * sizeof(State), sizeof(State));
+				node->move_cursor = snapshot_node.move_cursor;
+				node->terminal = snapshot_node.terminal != 0;
+				nodes.emplace_back(node);
+				return NodeValue{node, snapshot_node.value};
+			};
+			for (size_t i = 0; i < header.depth_count; ++i) {
+				NodeDepth& depth = depths[i];
+				const uint64_t heap_counts[NodeDepth::kHeapCount] = {snapshot_depths[i].unsearched_count, snapshot_depths[i].terminal_count};
+				if (nodes.size() + heap_counts[0] + heap_counts[1] + snapshot_depths[i].searched_count > header.node_count) {
+					throw std::runtime_error("corrupt snapshot " + path);
+				}
+				for (size_t heap = 0; heap < NodeDepth::kHeapCount; ++heap) {
+					std::vector<NodeValue> entries;
+					entries.reserve(heap_counts[heap]);
+					for (size_t j = 0; j < heap_counts[heap]; ++j) {
+						entries.emplace_back(load_node());
+					}
+					if (!std::is_heap(entries.begin(), entries.end(), NodeValueCompare{})) {
+						throw std::runtime_error("corrupt snapshot " + path);
+					}
+					depth.get_heap(heap).import_heap(std::move(entries));
+				}
+				depth.searched.reserve(snapshot_depths[i].searched_count);
+				for (size_t j = 0; j < snapshot_depths[i].searched_count; ++j) {
+					depth.searched.emplace_back(load_node().node);
+					depth.searched.back()->expanded = true;
+				}
+			}
+			transposition_table.reserve(header.table_count);
+			for (size_t i = 0; i < header.table_count; ++i) {
+				if (snapshot_entries[i].node < nodes.size()) {
+					transposition_table.try_emplace(snapshot_entries[i].hash, nodes[snapshot_entries[i].node]->index);
+				}
+			}
+			if (is_tracking_links()) {
+				// visit counts are not part of the snapshot, every node restarts as a single visit of its value
+				statistics.resize(memory.capacity());
+				for (size_t i = 0; i < nodes.size(); ++i) {
+					statistics.reset_node(nodes[i]->index, nodes[i]->parent == nullptr ? 0 : 1, snapshot_nodes[i].value);
+				}
+				rebuild_links();
+			}
+			if (config.mode == SearchMode::best_first) {
+				rebuild_open_list();
+			}
+			node_cursor = {};
+			solution = header.solution < nodes.size() ? nodes[header.solution] : nullptr;
+			solution_value = header.solution_value;
+			pending_child.active = false;
+			node_cursor.depth = header.cursor_depth < depths.size() - 1 ? header.cursor_depth : 0;
+			total_searched = header.total_searched;
+			total_collision = header.total_collision;
+		}
+
+		// true when more search is unlikely to change get_result(), see NodeTreeConfig::early_stop
+		bool is_decision_settled() {
+			flush_pending_child();
+			run_cleanup(false);
+			if (solution != nullptr) {
+				return true;
+			}
+			struct RootChildSummary {
+				double score;
+				size_t weight;
+			};
+			std::unordered_map<const Node*, RootChildSummary> summary;
+			size_t total_weight = 0;
+			Node* root = get_root();
+			if (config.mode == SearchMode::mcts) {
+				if (root == nullptr) {
+					return false;
+				}
+				for (uint32_t i = statistics.first_child[root->index]; i != NodeStatistics::kNone; i = statistics.next_sibling[i]) {
+					summary[memory.get(i)] = {statistics.get_mean(i), statistics.visits[i]};
+					total_weight += statistics.visits[i];
+				}
+			} else {
+				// the frontier only says something once it has reached the depth horizon, in beam mode once it is
+				// below the root children
+				size_t last_depth_index = get_last_active_depth_index();
+				if (last_depth_index == std::numeric_limits<size_t>::max() || last_depth_index == 0 || (config.mode != SearchMode::beam && last_depth_index != depths.size() - 1)) {
+					return false;
+				}
+				for (size_t heap = 0; heap < NodeDepth::kHeapCount; ++heap) {
+					for (const NodeValue& node_value : depths[last_depth_index].get_heap(heap).get_container()) {
+						auto [it, inserted] = summary.try_emplace(node_value.node->get_first_parent(), RootChildSummary{node_value.value, 0});
+						it->second.score = std::max(it->second.score, node_value.value);
+						++it->second.weight;
+						++total_weight;
+					}
+				}
+				if (config.backup != ValueBackup::none && root != nullptr) {
+					for (uint32_t i = statistics.first_child[root->index]; i != NodeStatistics::kNone; i = statistics.next_sibling[i]) {
+						summary.try_emplace(memory.get(i), RootChildSummary{0, 0}).first->second.score = statistics.backed_value[i];
+					}
+				}
+			}
+			if (total_weight == 0) {
+				return false;
+			}
+			const RootChildSummary* best = nullptr;
+			double second_score = std::numeric_limits<double>::lowest();
+			for (const auto& [node, child_summary] : summary) {
+				if (best == nullptr || child_summary.score > best->score) {
+					if (best != nullptr) {
+						second_score = best->score;
+					}
+					best = &child_summary;
+				} else {
+					second_score = std::max(second_score, child_summary.score);
+				}
+			}
+			double coverage = static_cast<double>(best->weight) / static_cast<double>(total_weight);
+			return best->score - second_score >= config.early_stop_margin && coverage >= config.early_stop_coverage;
+		}
+
+		bool is_solution_found() {
+			run_cleanup(false);
+			return solution != nullptr;
+		}
+
+		// states from the root's child down to the terminal node found with stop_on_solution
+		std::vector<const State*> get_solution_path() {
+			run_cleanup(false);
+			std::vector<const State*> path;
+			for (const Node* node = solution; node != nullptr && node->parent != nullptr; node = node->parent) {
+				path.emplace_back(&node->state);
+				for (uint32_t i = node->chain_length; i-- > 0;) {
+					path.emplace_back(&chains[node->index][i]);
+				}
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		bool are_depths_populated() {
+			flush_pending_child();
+			run_cleanup(false);
+			if (config.mode == SearchMode::mcts) {
+				return get_most_visited_root_child() != nullptr;
+			}
 			size_t last_depth_index = get_last_active_depth_index();
 			if (last_depth_index == depths.size() - 1) {
 				return true;
@@ -436,6 +2700,29 @@ namespace noir::ctt {
 		size_t get_total_collision_count() const {
 			return total_collision;
 		}
+
+		size_t get_total_shared_hit_count() const {
+			return total_shared_hit;
+		}
+
+		size_t get_total_bound_skip_count() const {
+			return total_bound_skip;
+		}
+
+		// sampled task node reads of numa_aware workers that hit memory on their own node or on another one
+		size_t get_total_numa_local_count() const {
+			return total_numa_local;
+		}
+
+		size_t get_total_numa_remote_count() const {
+			return total_numa_remote;
+		}
+
+		// share of the sampled reads that went to another node, 0 without samples
+		double get_remote_access_ratio() const {
+			size_t total = total_numa_local + total_numa_remote;
+			return total == 0 ? 0.0 : static_cast<double>(total_numa_remote) / static_cast<double>(total);
+		}
 	};
 
 } // namespace noir
\ No newline at end of file
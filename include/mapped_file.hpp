@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace noir {
+	// read-only private mapping of a whole file
+	class MappedFile {
+	    private:
+		void* data = nullptr;
+		size_t size = 0;
+
+		void unmap() {
+			if (data != nullptr) {
+				munmap(data, size);
+				data = nullptr;
+				size = 0;
+			}
+		}
+
+	    public:
+		MappedFile() = default;
+
+		explicit MappedFile(const std::string& path) {
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				throw std::runtime_error("cannot open " + path);
+			}
+			struct stat file_stat;
+			if (fstat(fd, &file_stat) != 0) {
+				::close(fd);
+				throw std::runtime_error("cannot stat " + path);
+			}
+			size = static_cast<size_t>(file_stat.st_size);
+			if (size != 0) {
+				data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			}
+			::close(fd);
+			if (data == MAP_FAILED) {
+				data = nullptr;
+				size = 0;
+				throw std::runtime_error("cannot map " + path);
+			}
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept
+		    : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)) {}
+
+		MappedFile& operator=(MappedFile&& other) noexcept {
+			if (this != &other) {
+				unmap();
+				data = std::exchange(other.data, nullptr);
+				size = std::exchange(other.size, 0);
+			}
+			return *this;
+		}
+
+		~MappedFile() {
+			unmap();
+		}
+
+		const std::byte* get_data() const {
+			return static_cast<const std::byte*>(data);
+		}
+
+		size_t get_size() const {
+			return size;
+		}
+
+		template <typename T>
+		const T* at(const size_t offset, const size_t count = 1) const {
+			if (offset > size || count > (size - offset) / sizeof(T)) {
+				throw std::runtime_error("mapped file is truncated");
+			}
+			return reinterpret_cast<const T*>(get_data() + offset);
+		}
+	};
+} // namespace noir
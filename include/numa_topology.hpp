@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace noir {
+	// NUMA nodes and their cpus as far as this process may run on them, read from sysfs without libnuma.
+	// Falls back to a single node holding every allowed cpu when sysfs has no node directories.
+	class NumaTopology {
+	    private:
+		static constexpr int kMpolFNode = 1 << 0; // get_mempolicy flags from <numaif.h>
+		static constexpr int kMpolFAddr = 1 << 1;
+
+		std::vector<std::vector<int>> node_cpus; // allowed cpus per node, nodes without any are left out
+		std::vector<int> cpu_nodes;              // kernel node id per cpu, -1 when unknown
+
+		// "0-3,8-11" style list
+		static std::vector<int> parse_cpu_list(const std::string& text) {
+			std::vector<int> cpus;
+			std::stringstream stream(text);
+			std::string range;
+			while (std::getline(stream, range, ',')) {
+				size_t dash = range.find('-');
+				try {
+					int first = std::stoi(range.substr(0, dash));
+					int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+					for (int cpu = first; cpu <= last; ++cpu) {
+						cpus.emplace_back(cpu);
+					}
+				} catch (const std::exception&) {
+					// blank line or trailing separator
+				}
+			}
+			return cpus;
+		}
+
+		void add_node(const int id, std::vector<int> cpus, const cpu_set_t& allowed) {
+			std::erase_if(cpus, [&allowed](const int cpu) { return cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed); });
+			if (cpus.empty()) {
+				return;
+			}
+			for (int cpu : cpus) {
+				if (static_cast<size_t>(cpu) >= cpu_nodes.size()) {
+					cpu_nodes.resize(cpu + 1, -1);
+				}
+				cpu_nodes[cpu] = id;
+			}
+			node_cpus.emplace_back(std::move(cpus));
+		}
+
+	    public:
+		NumaTopology() {
+			cpu_set_t allowed;
+			CPU_ZERO(&allowed);
+			if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+				for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()) && cpu < CPU_SETSIZE; ++cpu) {
+					CPU_SET(cpu, &allowed);
+				}
+			}
+			std::error_code error;
+			std::vector<std::pair<int, std::filesystem::path>> nodes;
+			for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+				std::string name = entry.path().filename().string();
+				if (name.size() > 4 && name.starts_with("node") && std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+					nodes.emplace_back(std::stoi(name.substr(4)), entry.path());
+				}
+			}
+			std::sort(nodes.begin(), nodes.end());
+			for (const auto& [id, path] : nodes) {
+				std::ifstream file(path / "cpulist");
+				std::string text;
+				std::getline(file, text);
+				add_node(id, parse_cpu_list(text), allowed);
+			}
+			if (node_cpus.empty()) {
+				std::vector<int> cpus;
+				for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+					if (CPU_ISSET(cpu, &allowed)) {
+						cpus.emplace_back(cpu);
+					}
+				}
+				if (cpus.empty()) {
+					cpus.emplace_back(0);
+					CPU_SET(0, &allowed);
+				}
+				add_node(0, std::move(cpus), allowed);
+			}
+		}
+
+		static const NumaTopology& get() {
+			static const NumaTopology topology;
+			return topology;
+		}
+
+		size_t get_node_count() const {
+			return node_cpus.size();
+		}
+
+		int get_node_of_cpu(const int cpu) const {
+			return cpu < 0 || static_cast<size_t>(cpu) >= cpu_nodes.size() ? -1 : cpu_nodes[cpu];
+		}
+
+		// the cpu for worker index, workers go round robin over the nodes so every node's memory bandwidth is used
+		int get_worker_cpu(const size_t worker) const {
+			const std::vector<int>& cpus = node_cpus[worker % node_cpus.size()];
+			return cpus[(worker / node_cpus.size()) % cpus.size()];
+		}
+
+		// node of the cpu the calling thread runs on right now, -1 when unknown
+		int get_current_node() const {
+			return get_node_of_cpu(sched_getcpu());
+		}
+
+		// node holding the page of address, -1 when the kernel cannot tell (no NUMA support or page not touched yet)
+		static int get_page_node(const void* address) {
+			int node = -1;
+			if (syscall(SYS_get_mempolicy, &node, nullptr, 0, address, kMpolFNode | kMpolFAddr) != 0) {
+				return -1;
+			}
+			return node;
+		}
+	};
+
+	// Counts the first and then every kInterval-th sampled address as local or remote to the node the sampling thread runs on,
+	// one get_mempolicy call per sample. node stays -1, and nothing is counted, until set.
+	struct NumaAccessSampler {
+		static constexpr size_t kInterval = 64;
+
+		int node = -1;
+		size_t tick = 0;
+		size_t local_count = 0;
+		size_t remote_count = 0;
+
+		void sample(const void* address) {
+			if (node < 0 || tick++ % kInterval != 0) {
+				return;
+			}
+			int page_node = NumaTopology::get_page_node(address);
+			if (page_node >= 0) {
+				++(page_node == node ? local_count : remote_count);
+			}
+		}
+	};
+
+	// pins the calling thread to one cpu for its lifetime and restores the previous affinity afterwards
+	class ScopedThreadPin {
+	    private:
+		cpu_set_t previous;
+		bool pinned = false;
+
+	    public:
+		explicit ScopedThreadPin(const int cpu) {
+			if (cpu < 0 || cpu >= CPU_SETSIZE || pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) != 0) {
+				return;
+			}
+			cpu_set_t target;
+			CPU_ZERO(&target);
+			CPU_SET(cpu, &target);
+			pinned = pthread_setaffinity_np(pthread_self(), sizeof(target), &target) == 0;
+		}
+
+		ScopedThreadPin(const ScopedThreadPin&) = delete;
+		ScopedThreadPin& operator=(const ScopedThreadPin&) = delete;
+
+		~ScopedThreadPin() {
+			if (pinned) {
+				pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+			}
+		}
+	};
+} // namespace noir
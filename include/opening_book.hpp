@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+namespace noir {
+	// read-only (state hash -> best move, value) table, sorted by hash and mapped from disk
+	template <typename Move>
+	class OpeningBook {
+	    public:
+		static_assert(std::is_trivially_copyable_v<Move>);
+
+		struct Entry {
+			uint64_t hash;
+			double value;
+			Move move;
+		};
+
+	    private:
+		struct Header {
+			uint64_t magic;
+			uint64_t entry_size;
+			uint64_t entry_count;
+		};
+
+		static constexpr uint64_t kBookMagic = 0x314b4f4f42524f4e; // "NORBOOK1"
+
+		MappedFile file;
+		const Entry* entries = nullptr;
+		size_t entry_count = 0;
+
+	    public:
+		OpeningBook() = default;
+
+		explicit OpeningBook(const std::string& path)
+		    : file(path) {
+			const Header& header = *file.template at<Header>(0);
+			if (header.magic != kBookMagic || header.entry_size != sizeof(Entry)) {
+				throw std::runtime_error("incompatible opening book " + path);
+			}
+			entries = file.template at<Entry>(sizeof(Header), header.entry_count);
+			entry_count = header.entry_count;
+		}
+
+		const Entry* find(const uint64_t hash) const {
+			const Entry* end = entries + entry_count;
+			const Entry* it = std::lower_bound(entries, end, hash, [](const Entry& entry, uint64_t key) { return entry.hash < key; });
+			if (it == end || it->hash != hash) {
+				return nullptr;
+			}
+			return it;
+		}
+
+		size_t size() const {
+			return entry_count;
+		}
+
+		bool empty() const {
+			return entry_count == 0;
+		}
+
+		// sorts by hash and keeps the first entry of each hash
+		static void write(const std::string& path, std::vector<Entry> new_entries) {
+			std::stable_sort(new_entries.begin(), new_entries.end(), [](const Entry& left, const Entry& right) { return left.hash < right.hash; });
+			auto last = std::unique(new_entries.begin(), new_entries.end(), [](const Entry& left, const Entry& right) { return left.hash == right.hash; });
+			new_entries.erase(last, new_entries.end());
+			Header header = {kBookMagic, sizeof(Entry), new_entries.size()};
+			std::ofstream out(path, std::ios::binary | std::ios::trunc);
+			if (!out) {
+				throw std::runtime_error("cannot open " + path);
+			}
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(new_entries.data()), static_cast<std::streamsize>(new_entries.size() * sizeof(Entry)));
+			if (!out) {
+				throw std::runtime_error("cannot write " + path);
+			}
+		}
+	};
+} // namespace noir
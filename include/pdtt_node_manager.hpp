@@ -228,6 +228,7 @@ namespace noir::pdtt {
 	    private:
 		NodeMemory memory;
 		NodeCursor node_cursor;
+		State scratch_state;
 		std::vector<NodeDepth> depths;
 		NodeTreeConfig config;
 		size_t total_searched;
@@ -417,6 +418,28 @@ namespace noir::pdtt {
 			depths[node_cursor.depth + 1].push(node_cursor.allocated_node, value);
 		}
 
+		// applies move to a scratch copy of the current task and only commits it to the node pool if it is not a duplicate
+		template <typename Move, typename ApplyFunc, typename EvaluateFunc>
+		bool try_child(const Move& move, ApplyFunc&& apply_fn, EvaluateFunc&& evaluate_fn) {
+			if (node_cursor.cursor == nullptr || node_cursor.cursor->pruned) {
+				return false;
+			}
+			scratch_state = node_cursor.cursor->state;
+			apply_fn(scratch_state, move);
+			uint64_t hash = state_hash(scratch_state);
+			auto [it, inserted] = depths[node_cursor.depth].transposition_table.try_emplace(hash, nullptr);
+			if (!inserted) {
+				++total_collision;
+				return false;
+			}
+			double value = evaluate_fn(scratch_state);
+			node_cursor.allocated_node = memory.allocate(node_cursor.cursor);
+			node_cursor.allocated_node->state = scratch_state;
+			it->second = node_cursor.allocated_node;
+			report_result(value);
+			return true;
+		}
+
 		const State* get_result() const {
 			size_t last_depth_index = get_last_active_depth_index();
 			if (depths[last_depth_index].unsearched.empty()) {
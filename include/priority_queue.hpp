@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
 #include <queue>
 
 namespace noir {
@@ -22,6 +24,10 @@ namespace noir {
 		PriorityQueue(const Compare& comp, const Container& cont)
 		    : std::priority_queue<T, Container, Compare>(comp, cont) {}
 
+		const Container& get_container() const {
+			return this->c;
+		}
+
 		Container export_container() {
 			return std::move(this->c);
 		}
@@ -30,5 +36,11 @@ namespace noir {
 			this->c = std::move(new_data);
 			std::make_heap(this->c.begin(), this->c.end(), this->comp);
 		}
+
+		// takes a container already in heap order as is, make_heap may reorder equal elements
+		void import_heap(Container&& new_data) {
+			assert(std::is_heap(new_data.begin(), new_data.end(), this->comp));
+			this->c = std::move(new_data);
+		}
 	};
 } // namespace noir
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace noir {
+	// Bounded lock-free queue for one producer and one consumer thread, capacity is rounded up to a power of two.
+	// Each side keeps a copy of the other side's index and only reloads it when the ring looks full or empty.
+	template <typename T>
+	class SpscRing {
+	    private:
+		size_t mask;
+		std::unique_ptr<T[]> slots;
+		alignas(64) std::atomic<size_t> head = 0; // next slot to pop, advanced by the consumer
+		size_t cached_tail = 0;                   // consumer's copy of tail
+		alignas(64) std::atomic<size_t> tail = 0; // next slot to push, advanced by the producer
+		size_t cached_head = 0;                   // producer's copy of head
+
+	    public:
+		explicit SpscRing(const size_t capacity)
+		    : mask(std::bit_ceil(std::max<size_t>(2, capacity)) - 1), slots(std::make_unique<T[]>(mask + 1)) {}
+
+		// producer only, value is left untouched when the ring is full
+		template <typename U>
+		bool try_push(U&& value) {
+			size_t position = tail.load(std::memory_order_relaxed);
+			if (position - cached_head > mask) {
+				cached_head = head.load(std::memory_order_acquire);
+				if (position - cached_head > mask) {
+					return false;
+				}
+			}
+			slots[position & mask] = std::forward<U>(value);
+			tail.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only
+		bool try_pop(T& value) {
+			size_t position = head.load(std::memory_order_relaxed);
+			if (position == cached_tail) {
+				cached_tail = tail.load(std::memory_order_acquire);
+				if (position == cached_tail) {
+					return false;
+				}
+			}
+			value = std::move(slots[position & mask]);
+			head.store(position + 1, std::memory_order_release);
+			return true;
+		}
+	};
+
+	// Bounded lock-free queue for several producer threads and one consumer, after Vyukov's bounded MPMC queue:
+	// every cell carries a sequence number that tells producers whether it is free and the consumer whether it is filled.
+	template <typename T>
+	class MpscRing {
+	    private:
+		struct Cell {
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		size_t mask;
+		std::unique_ptr<Cell[]> cells;
+		alignas(64) std::atomic<size_t> tail = 0; // next cell to claim, shared by the producers
+		alignas(64) size_t head = 0;              // next cell to pop, consumer only
+
+	    public:
+		explicit MpscRing(const size_t capacity)
+		    : mask(std::bit_ceil(std::max<size_t>(2, capacity)) - 1), cells(std::make_unique<Cell[]>(mask + 1)) {
+			for (size_t i = 0; i <= mask; ++i) {
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		// any thread, value is left untouched when the ring is full
+		template <typename U>
+		bool try_push(U&& value) {
+			size_t position = tail.load(std::memory_order_relaxed);
+			while (true) {
+				Cell& cell = cells[position & mask];
+				size_t sequence = cell.sequence.load(std::memory_order_acquire);
+				auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+				if (difference == 0) {
+					if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						cell.value = std::forward<U>(value);
+						cell.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				} else if (difference < 0) {
+					return false;
+				} else {
+					position = tail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// consumer only
+		bool try_pop(T& value) {
+			Cell& cell = cells[head & mask];
+			if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+				return false;
+			}
+			value = std::move(cell.value);
+			cell.sequence.store(head + mask + 1, std::memory_order_release);
+			++head;
+			return true;
+		}
+	};
+} // namespace noir
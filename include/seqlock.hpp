@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace noir {
+	// Single-writer sequence lock around a trivially copyable value. store() never waits for readers and load()
+	// never blocks the writer: a reader copies the value and retries when the sequence moved under it.
+	// The value is kept in relaxed atomic words, so a torn copy is discarded rather than being a data race.
+	template <typename T>
+	class SeqLock {
+	    private:
+		static constexpr size_t kWordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		alignas(64) std::atomic<uint64_t> sequence = 0; // odd while a store is in progress
+		std::atomic<uint64_t> words[kWordCount] = {};
+
+	    public:
+		// only one thread may store
+		void store(const T& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			uint64_t buffer[kWordCount] = {};
+			std::memcpy(buffer, &value, sizeof(T));
+			uint64_t current = sequence.load(std::memory_order_relaxed);
+			sequence.store(current + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (size_t i = 0; i < kWordCount; ++i) {
+				words[i].store(buffer[i], std::memory_order_relaxed);
+			}
+			sequence.store(current + 2, std::memory_order_release);
+		}
+
+		// the last stored value, all zero bytes before the first store
+		T load() const {
+			static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>);
+			uint64_t buffer[kWordCount];
+			while (true) {
+				uint64_t before = sequence.load(std::memory_order_acquire);
+				if (before % 2 != 0) {
+					std::this_thread::yield();
+					continue;
+				}
+				for (size_t i = 0; i < kWordCount; ++i) {
+					buffer[i] = words[i].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) == before) {
+					break;
+				}
+			}
+			T value{};
+			std::memcpy(&value, buffer, sizeof(T));
+			return value;
+		}
+
+		// number of completed stores
+		uint64_t get_version() const {
+			return sequence.load(std::memory_order_acquire) / 2;
+		}
+	};
+} // namespace noir
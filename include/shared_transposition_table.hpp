@@ -0,0 +1,181 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace noir {
+	// Fixed-size (hash -> value) table in POSIX shared memory that several processes attach to by name.
+	// Entries are versioned: a writer moves the version to odd with CAS, writes, then publishes the next even
+	// version; readers retry-free discard anything whose version changed or was odd while they read it.
+	// Lossy by design, a busy or evicted entry is simply a miss.
+	class SharedTranspositionTable {
+	    private:
+		static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+		struct alignas(32) Entry {
+			std::atomic<uint64_t> version;
+			std::atomic<uint64_t> hash;
+			std::atomic<uint64_t> value;
+			std::atomic<uint64_t> terminal;
+		};
+
+		struct Header {
+			std::atomic<uint64_t> magic;
+			uint64_t capacity;
+		};
+
+		static constexpr uint64_t kTableMagic = 0x3254545348524f4e; // "NORHSTT2"
+		static constexpr size_t kProbeCount = 4;
+		static constexpr int kAttachAttempts = 1000; // yields an attaching process waits for the creator, per step
+
+		Header* header = nullptr;
+		Entry* entries = nullptr;
+		size_t mapped_size = 0;
+		uint64_t mask = 0;
+
+		static size_t get_mapped_size(const size_t capacity) {
+			return sizeof(Entry) + capacity * sizeof(Entry); // header padded to one entry
+		}
+
+		Entry& get_entry(const uint64_t hash, const size_t probe) const {
+			return entries[(hash + probe) & mask];
+		}
+
+	    public:
+		// creates the segment with capacity rounded up to a power of two, or attaches to an existing one
+		SharedTranspositionTable(const std::string& name, size_t capacity) {
+			capacity = std::bit_ceil(capacity < kProbeCount ? kProbeCount : capacity);
+			bool created = true;
+			int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+			if (fd < 0 && errno == EEXIST) {
+				created = false;
+				fd = shm_open(name.c_str(), O_RDWR, 0600);
+			}
+			if (fd < 0) {
+				throw std::runtime_error("cannot open shared memory " + name);
+			}
+			if (created) {
+				if (ftruncate(fd, static_cast<off_t>(get_mapped_size(capacity))) != 0) {
+					::close(fd);
+					shm_unlink(name.c_str());
+					throw std::runtime_error("cannot size shared memory " + name);
+				}
+			} else {
+				// the creator may still be sizing the segment
+				struct stat segment_stat;
+				for (int i = 0; fstat(fd, &segment_stat) == 0 && static_cast<size_t>(segment_stat.st_size) < sizeof(Entry); ++i) {
+					if (i == kAttachAttempts) {
+						::close(fd);
+						throw std::runtime_error("shared memory " + name + " was never initialized");
+					}
+					std::this_thread::yield();
+				}
+				capacity = (static_cast<size_t>(segment_stat.st_size) - sizeof(Entry)) / sizeof(Entry);
+			}
+			mapped_size = get_mapped_size(capacity);
+			void* data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (data == MAP_FAILED) {
+				throw std::runtime_error("cannot map shared memory " + name);
+			}
+			header = static_cast<Header*>(data);
+			entries = reinterpret_cast<Entry*>(static_cast<std::byte*>(data) + sizeof(Entry));
+			if (created) {
+				header->capacity = capacity;
+				header->magic.store(kTableMagic, std::memory_order_release);
+			} else {
+				// 0 until the creator has written the header, anything else is a segment of another layout
+				uint64_t magic = header->magic.load(std::memory_order_acquire);
+				for (int i = 0; magic == 0 && i < kAttachAttempts; ++i) {
+					std::this_thread::yield();
+					magic = header->magic.load(std::memory_order_acquire);
+				}
+				if (magic == 0) {
+					munmap(data, mapped_size);
+					throw std::runtime_error("shared memory " + name + " was never initialized");
+				}
+				if (magic != kTableMagic || header->capacity != capacity || !std::has_single_bit(capacity)) {
+					munmap(data, mapped_size);
+					throw std::runtime_error("incompatible shared memory " + name);
+				}
+			}
+			mask = capacity - 1;
+		}
+
+		SharedTranspositionTable(const SharedTranspositionTable&) = delete;
+		SharedTranspositionTable& operator=(const SharedTranspositionTable&) = delete;
+
+		~SharedTranspositionTable() {
+			munmap(header, mapped_size);
+		}
+
+		// the segment lives until unlinked, even when no process has it attached
+		static void unlink(const std::string& name) {
+			shm_unlink(name.c_str());
+		}
+
+		size_t capacity() const {
+			return mask + 1;
+		}
+
+		bool find(const uint64_t hash, double& value) const {
+			bool terminal;
+			return find(hash, value, terminal);
+		}
+
+		bool find(const uint64_t hash, double& value, bool& terminal) const {
+			for (size_t i = 0; i < kProbeCount; ++i) {
+				Entry& entry = get_entry(hash, i);
+				uint64_t version = entry.version.load(std::memory_order_acquire);
+				if (version == 0) {
+					return false;
+				}
+				if (version & 1) {
+					continue;
+				}
+				uint64_t entry_hash = entry.hash.load(std::memory_order_relaxed);
+				uint64_t entry_value = entry.value.load(std::memory_order_relaxed);
+				uint64_t entry_terminal = entry.terminal.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (entry.version.load(std::memory_order_relaxed) == version && entry_hash == hash) {
+					value = std::bit_cast<double>(entry_value);
+					terminal = entry_terminal != 0;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void store(const uint64_t hash, const double value, const bool terminal = false) {
+			// prefer the slot already holding hash, then an empty slot, else replace the home slot
+			Entry* target = &get_entry(hash, 0);
+			for (size_t i = 0; i < kProbeCount; ++i) {
+				Entry& entry = get_entry(hash, i);
+				if (entry.version.load(std::memory_order_relaxed) == 0 || entry.hash.load(std::memory_order_relaxed) == hash) {
+					target = &entry;
+					break;
+				}
+			}
+			uint64_t version = target->version.load(std::memory_order_relaxed);
+			if ((version & 1) || !target->version.compare_exchange_strong(version, version + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+				return;
+			}
+			// orders the odd version before the data, so a reader that sees new data also sees the entry as busy
+			std::atomic_thread_fence(std::memory_order_release);
+			target->hash.store(hash, std::memory_order_relaxed);
+			target->value.store(std::bit_cast<uint64_t>(value), std::memory_order_relaxed);
+			target->terminal.store(terminal, std::memory_order_relaxed);
+			target->version.store(version + 2, std::memory_order_release);
+		}
+	};
+} // namespace noir
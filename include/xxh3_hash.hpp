@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// NOIR_XXH_DISPATCH is set by the build when xxh_x86dispatch.c is linked in,
+// so XXH3 picks the best of SSE2/AVX2/AVX-512 at runtime instead of relying on -march
+#if defined(NOIR_XXH_DISPATCH) && NOIR_XXH_DISPATCH
+#include "third_party/xxHash/xxh_x86dispatch.h"
+#else
+#include "third_party/xxHash/xxhash.h"
+#endif
+
+namespace noir {
+	inline uint64_t xxh3_64bits(const void* data, const size_t size) {
+		return XXH3_64bits(data, size);
+	}
+
+	// hashes the whole object, only valid when State has no padding
+	template <typename State>
+	struct XXH3Hash {
+		static_assert(std::is_trivially_copyable_v<State>);
+		static_assert(std::has_unique_object_representations_v<State>);
+
+		static uint64_t operator()(const State& state) {
+			return xxh3_64bits(&state, sizeof(State));
+		}
+	};
+
+	// hashes a single trivially copyable member, e.g. XXH3MemberHash<&SudokuState::board>
+	template <auto Member>
+	struct XXH3MemberHash {
+		template <typename State>
+		static uint64_t operator()(const State& state) {
+			const auto& member = state.*Member;
+			static_assert(std::is_trivially_copyable_v<std::remove_cvref_t<decltype(member)>>);
+			return xxh3_64bits(&member, sizeof(member));
+		}
+	};
+} // namespace noir
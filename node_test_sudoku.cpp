@@ -1,149 +1,33 @@
 #include "include/ctt_node_manager.hpp"
-#include "include/third_party/xxHash/xxhash.h"
-#include <array>
+#include "include/opening_book.hpp"
+#include "sudoku.hpp"
 #include <chrono>
-#include <cstddef>
-#include <cstring>
 #include <iostream>
 
-struct SudokuDecision {
-	uint8_t x;
-	uint8_t y;
-	uint8_t number;
-};
-
-struct SudokuState {
-	// col, row
-	uint8_t board[9][9] = {};
-	SudokuDecision decision = {};
-
-	bool operator==(const SudokuState& other) const {
-		return std::memcmp(board, other.board, sizeof(board)) == 0;
-	}
-
-	bool operator!=(const SudokuState& other) const {
-		return std::memcmp(board, other.board, sizeof(board)) != 0;
-	}
-
-	int get_column_match_count(const size_t column) const {
-		int match[10] = {};
-		for (size_t row = 0; row < 9; ++row) {
-			++match[board[column][row]];
-		}
-		int result = 0;
-		for (int i = 1; i < 10; ++i) {
-			result += match[i] != 0;
-		}
-		return result;
-	}
-
-	int get_row_match_count(const size_t row) const {
-		int match[10] = {};
-		for (size_t column = 0; column < 9; ++column) {
-			++match[board[column][row]];
-		}
-		int result = 0;
-		for (int i = 1; i < 10; ++i) {
-			result += match[i] != 0;
-		}
-		return result;
-	}
-
-	int get_block_match_count(const size_t block) const {
-		int match[10] = {};
-		size_t col_start = (block * 3) % 9;
-		size_t row_start = (block / 3) * 3;
-		size_t col_end = col_start + 3;
-		size_t row_end = row_start + 3;
-		for (size_t i = col_start; i < col_end; ++i) {
-			for (size_t j = row_start; j < row_end; ++j) {
-				++match[board[i][j]];
-			}
-		}
-		int result = 0;
-		for (int i = 1; i < 10; ++i) {
-			result += match[i] != 0;
-		}
-		return result;
-	}
-
-	int get_zero_count() const {
-		int count = 0;
-		for (size_t x = 0; x < 9; ++x) {
-			for (size_t y = 0; y < 9; ++y) {
-				if (board[x][y] == 0) {
-					++count;
-				}
-			}
-		}
-		return count;
-	}
-
-	bool is_solved() const {
-		for (size_t i = 0; i < 9; ++i) {
-			size_t matches = 0;
-			matches += get_block_match_count(i);
-			matches += get_row_match_count(i);
-			matches += get_column_match_count(i);
-			if (matches != 27) {
-				return false;
-			}
-		}
-		return true;
-	}
-
-	double evaluate() {
-		double score = 0.0;
-		for (size_t i = 0; i < 9; ++i) {
-			score += get_block_match_count(i);
-			score += get_row_match_count(i);
-			score += get_column_match_count(i);
-		}
-		score -= get_zero_count();
-		return score;
-	}
-};
-
-struct SudokuHashFunc {
-	uint64_t operator()(const SudokuState& state) const {
-		return XXH3_64bits(state.board, sizeof(state.board));
-	}
-};
-
-template <typename State>
-struct CollisionFunc {
-	static bool operator()(const State& a, const State& b) {
-		return a == b;
-	}
-};
-
-// get all possible moves from 9x9 board with 1-9 num
-constexpr std::array<SudokuDecision, 9 * 9 * 9> get_all_possible_moves() {
-	std::array<SudokuDecision, 9 * 9 * 9> moves = {};
-	size_t index = 0;
-	for (size_t x = 0; x < 9; ++x) {
-		for (size_t y = 0; y < 9; ++y) {
-			for (size_t n = 1; n < 10; ++n) {
-				SudokuDecision decision;
-				decision.x = x;
-				decision.y = y;
-				decision.number = n;
-				moves[index++] = decision;
-			}
-		}
-	}
-	return moves;
-}
-
-int main() {
+int main(int argc, char** argv) {
 	constexpr int kMillisecondsPerMove = 25;
-	noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc> node_sudoku;
+	noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc, SudokuCanonicalize> node_sudoku;
 	node_sudoku.get_config().depth = 7;
 	node_sudoku.get_config().node_limit = 100000;
 	node_sudoku.get_config().prune_depth_limit = 0;
+	node_sudoku.get_config().stop_on_solution = true;
+	node_sudoku.get_config().early_stop = true;
+	node_sudoku.get_config().early_stop_margin = 2.0;
+	node_sudoku.get_config().early_stop_coverage = 0.6;
+	// optional book built by sudoku_book, consulted before searching each position
+	noir::OpeningBook<SudokuDecision> book;
+	if (argc > 1) {
+		book = noir::OpeningBook<SudokuDecision>(argv[1]);
+	}
 	SudokuState sudoku_state;
 	size_t attempts = 0;
 	while (!sudoku_state.is_solved()) {
+		if (const auto* entry = book.find(SudokuHashFunc{}(sudoku_state))) {
+			apply_move(sudoku_state, entry->move);
+			++attempts;
+			std::cout << "Attempt #" << attempts << " (book)" << std::endl;
+			continue;
+		}
 		node_sudoku.prepare_tree(sudoku_state);
 		auto now = std::chrono::high_resolution_clock::now();
 		// exit conditions:
@@ -156,14 +40,7 @@ int main() {
 			}
 			constexpr auto all_moves = get_all_possible_moves();
 			for (const auto& move : all_moves) {
-				auto new_state = node_sudoku.get_new_state();
-				*new_state = *parent_state;
-				new_state->decision = move;
-				new_state->board[move.x][move.y] = move.number;
-				if (!node_sudoku.verify_state()) {
-					continue;
-				}
-				node_sudoku.report_result(new_state->evaluate());
+				node_sudoku.try_child(move, apply_move, [](SudokuState& state) { return noir::ctt::Evaluation{state.evaluate(), state.is_solved()}; });
 			}
 			node_sudoku.increment_depth_counter();
 		} while (std::chrono::high_resolution_clock::now() - now < std::chrono::milliseconds(kMillisecondsPerMove) || !node_sudoku.are_depths_populated());
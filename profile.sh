@@ -1,3 +1,3 @@
-clang++ -std=c++20 -pg -o main node_test_sudoku.cpp include/third_party/xxHash/xxhash.c -march=native && ./main
+clang++ -std=c++20 -pg -o main node_test_sudoku.cpp include/third_party/xxHash/xxhash.c include/third_party/xxHash/xxh_x86dispatch.c -DNOIR_XXH_DISPATCH=1 -march=native && ./main
 gprof main gmon.out > analysis.txt
 cat analysis.txt
\ No newline at end of file
@@ -0,0 +1,203 @@
+#pragma once
+#include "include/xxh3_hash.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+struct SudokuDecision {
+	uint8_t x;
+	uint8_t y;
+	uint8_t number;
+};
+
+struct SudokuState {
+	// col, row
+	uint8_t board[9][9] = {};
+	SudokuDecision decision = {};
+
+	bool operator==(const SudokuState& other) const {
+		return std::memcmp(board, other.board, sizeof(board)) == 0;
+	}
+
+	bool operator!=(const SudokuState& other) const {
+		return std::memcmp(board, other.board, sizeof(board)) != 0;
+	}
+
+	int get_column_match_count(const size_t column) const {
+		int match[10] = {};
+		for (size_t row = 0; row < 9; ++row) {
+			++match[board[column][row]];
+		}
+		int result = 0;
+		for (int i = 1; i < 10; ++i) {
+			result += match[i] != 0;
+		}
+		return result;
+	}
+
+	int get_row_match_count(const size_t row) const {
+		int match[10] = {};
+		for (size_t column = 0; column < 9; ++column) {
+			++match[board[column][row]];
+		}
+		int result = 0;
+		for (int i = 1; i < 10; ++i) {
+			result += match[i] != 0;
+		}
+		return result;
+	}
+
+	int get_block_match_count(const size_t block) const {
+		int match[10] = {};
+		size_t col_start = (block * 3) % 9;
+		size_t row_start = (block / 3) * 3;
+		size_t col_end = col_start + 3;
+		size_t row_end = row_start + 3;
+		for (size_t i = col_start; i < col_end; ++i) {
+			for (size_t j = row_start; j < row_end; ++j) {
+				++match[board[i][j]];
+			}
+		}
+		int result = 0;
+		for (int i = 1; i < 10; ++i) {
+			result += match[i] != 0;
+		}
+		return result;
+	}
+
+	int get_zero_count() const {
+		int count = 0;
+		for (size_t x = 0; x < 9; ++x) {
+			for (size_t y = 0; y < 9; ++y) {
+				if (board[x][y] == 0) {
+					++count;
+				}
+			}
+		}
+		return count;
+	}
+
+	bool is_solved() const {
+		for (size_t i = 0; i < 9; ++i) {
+			size_t matches = 0;
+			matches += get_block_match_count(i);
+			matches += get_row_match_count(i);
+			matches += get_column_match_count(i);
+			if (matches != 27) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// upper bound of evaluate() right after decision, given the value before it: the row, column and block of the cell
+	// can each gain one digit and the cell may have been empty
+	double get_decision_bound(const double previous_value) const {
+		const size_t x = decision.x;
+		const size_t y = decision.y;
+		const uint8_t number = decision.number;
+		int row = 0;
+		int column = 0;
+		int block = 0;
+		for (size_t i = 0; i < 9; ++i) {
+			row += board[i][y] == number;
+			column += board[x][i] == number;
+			block += board[x / 3 * 3 + i % 3][y / 3 * 3 + i / 3] == number;
+		}
+		return previous_value + (row == 1) + (column == 1) + (block == 1) + 1;
+	}
+
+	double evaluate() {
+		double score = 0.0;
+		for (size_t i = 0; i < 9; ++i) {
+			score += get_block_match_count(i);
+			score += get_row_match_count(i);
+			score += get_column_match_count(i);
+		}
+		score -= get_zero_count();
+		return score;
+	}
+};
+
+using SudokuHashFunc = noir::XXH3MemberHash<&SudokuState::board>;
+
+struct SudokuSymmetry {
+	bool transposed;
+	uint8_t digits[10]; // canonical digit of each original digit
+};
+
+// relabels digits in order of first appearance and keeps the smaller of the board and its transpose,
+// evaluate() and the rules are invariant under both
+struct SudokuCanonicalize {
+	static SudokuSymmetry relabel(uint8_t (&board)[9][9], const bool transposed) {
+		SudokuSymmetry symmetry = {transposed, {}};
+		uint8_t next = 1;
+		for (size_t y = 0; y < 9; ++y) {
+			for (size_t x = 0; x < 9; ++x) {
+				uint8_t& cell = board[x][y];
+				if (cell != 0 && symmetry.digits[cell] == 0) {
+					symmetry.digits[cell] = next++;
+				}
+				cell = symmetry.digits[cell];
+			}
+		}
+		return symmetry;
+	}
+
+	static SudokuSymmetry operator()(SudokuState& state) {
+		uint8_t transposed[9][9];
+		for (size_t x = 0; x < 9; ++x) {
+			for (size_t y = 0; y < 9; ++y) {
+				transposed[x][y] = state.board[y][x];
+			}
+		}
+		SudokuSymmetry symmetry = relabel(state.board, false);
+		SudokuSymmetry transposed_symmetry = relabel(transposed, true);
+		if (std::memcmp(transposed, state.board, sizeof(transposed)) < 0) {
+			std::memcpy(state.board, transposed, sizeof(transposed));
+			return transposed_symmetry;
+		}
+		return symmetry;
+	}
+};
+
+template <typename State>
+struct CollisionFunc {
+	static bool operator()(const State& a, const State& b) {
+		return a == b;
+	}
+};
+
+inline void apply_move(SudokuState& state, const SudokuDecision& move) {
+	state.decision = move;
+	state.board[move.x][move.y] = move.number;
+}
+
+// 81 cells in row-major order, '0' = empty
+inline SudokuState parse_sudoku(const std::string_view cells) {
+	SudokuState state;
+	for (size_t i = 0; i < 81 && i < cells.size(); ++i) {
+		state.board[i % 9][i / 9] = static_cast<uint8_t>(cells[i] - '0');
+	}
+	return state;
+}
+
+// get all possible moves from 9x9 board with 1-9 num
+constexpr std::array<SudokuDecision, 9 * 9 * 9> get_all_possible_moves() {
+	std::array<SudokuDecision, 9 * 9 * 9> moves = {};
+	size_t index = 0;
+	for (size_t x = 0; x < 9; ++x) {
+		for (size_t y = 0; y < 9; ++y) {
+			for (size_t n = 1; n < 10; ++n) {
+				SudokuDecision decision;
+				decision.x = x;
+				decision.y = y;
+				decision.number = n;
+				moves[index++] = decision;
+			}
+		}
+	}
+	return moves;
+}
@@ -0,0 +1,55 @@
+#include "bench/sudoku_corpus.hpp"
+#include "ctt_node_manager.hpp"
+#include "opening_book.hpp"
+#include "sudoku.hpp"
+#include <iostream>
+#include <vector>
+
+// Offline opening book builder: plays every corpus puzzle with a deep search and records
+// (board hash -> chosen move, value) for each position on the played line.
+// usage: sudoku_book <output_file>
+
+namespace {
+	constexpr size_t kBookDepth = 9;
+	constexpr size_t kExpansionsPerMove = 5000;
+	constexpr size_t kBookMoves = 20;
+
+	using SudokuNodeManager = noir::ctt::NodeManager<SudokuState, CollisionFunc<SudokuState>, SudokuHashFunc>;
+	using SudokuBook = noir::OpeningBook<SudokuDecision>;
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "usage: " << argv[0] << " <output_file>" << std::endl;
+		return 1;
+	}
+	std::vector<SudokuBook::Entry> entries;
+	SudokuNodeManager node_sudoku;
+	node_sudoku.get_config().depth = kBookDepth;
+	node_sudoku.get_config().node_limit = 1000000;
+	node_sudoku.get_config().prune_depth_limit = 0;
+	for (const SudokuPuzzle& puzzle : kSudokuCorpus) {
+		SudokuState sudoku_state = parse_sudoku(puzzle.cells);
+		for (size_t move = 0; move < kBookMoves && !sudoku_state.is_solved(); ++move) {
+			node_sudoku.prepare_tree(sudoku_state);
+			for (size_t i = 0; i < kExpansionsPerMove; ++i) {
+				if (node_sudoku.get_task() == nullptr) {
+					break;
+				}
+				constexpr auto all_moves = get_all_possible_moves();
+				for (const auto& child_move : all_moves) {
+					node_sudoku.try_child(child_move, apply_move, [](SudokuState& state) { return state.evaluate(); });
+				}
+				node_sudoku.increment_depth_counter();
+			}
+			auto best_state = node_sudoku.get_result();
+			if (best_state == nullptr) {
+				break;
+			}
+			entries.push_back({SudokuHashFunc{}(sudoku_state), node_sudoku.get_result_value(), best_state->decision});
+			apply_move(sudoku_state, best_state->decision);
+		}
+		std::cout << puzzle.name << ": " << entries.size() << " positions" << std::endl;
+	}
+	SudokuBook::write(argv[1], std::move(entries));
+}